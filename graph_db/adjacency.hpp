@@ -0,0 +1,88 @@
+#ifndef ADJACENCY_HPP
+#define ADJACENCY_HPP
+
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief Read-only adjacency lists of all vertices stored as delta + zigzag varint encoded edge ids in one byte array.
+ * @note Lists in insertion order have increasing edge ids so most deltas fit into a single byte.
+ */
+class compressed_adjacency {
+public:
+
+    void build(const std::vector<std::vector<std::size_t>> &lists) {
+        //encodes every list, offsets_[v] is the first byte of the v-th list
+        offsets_.clear();
+        bytes_.clear();
+        offsets_.reserve(lists.size() + 1);
+        for (auto &&list : lists) {
+            offsets_.push_back(bytes_.size());
+            std::size_t prev = 0;
+            for (auto id : list) {
+                put_varint(zigzag(static_cast<std::int64_t>(id - prev)));
+                prev = id;
+            }
+        }
+        offsets_.push_back(bytes_.size());
+        bytes_.shrink_to_fit();
+    }
+
+    void unpack(std::vector<std::vector<std::size_t>> &lists) const {
+        //decodes all lists back
+        lists.assign(vertex_count(), {});
+        for (std::size_t v = 0; v < vertex_count(); ++v) {
+            std::size_t pos = offsets_[v], id = 0;
+            while (pos < offsets_[v + 1]) {
+                id = decode(pos, id);
+                lists[v].push_back(id);
+            }
+        }
+    }
+
+    void clear() {
+        std::vector<std::size_t>().swap(offsets_);
+        std::vector<std::uint8_t>().swap(bytes_);
+    }
+
+    std::size_t vertex_count() const noexcept { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+    std::size_t begin_of(std::size_t v) const noexcept { return offsets_[v]; }
+    std::size_t end_of(std::size_t v) const noexcept { return offsets_[v + 1]; }
+    const std::uint8_t *data() const noexcept { return bytes_.data(); }
+
+    std::size_t bytes() const noexcept {
+        return offsets_.capacity() * sizeof(std::size_t) + bytes_.capacity();
+    }
+
+    static std::size_t decode(const std::uint8_t *data, std::size_t &pos, std::size_t prev) noexcept {
+        //reads one varint at pos and advances pos behind it, returns prev + delta
+        std::uint64_t v = 0;
+        unsigned shift = 0;
+        std::uint8_t byte;
+        do {
+            byte = data[pos++];
+            v |= std::uint64_t(byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        return prev + static_cast<std::size_t>(unzigzag(v));
+    }
+
+private:
+    std::size_t decode(std::size_t &pos, std::size_t prev) const noexcept { return decode(bytes_.data(), pos, prev); }
+
+    static std::uint64_t zigzag(std::int64_t v) noexcept { return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63); }
+    static std::int64_t unzigzag(std::uint64_t v) noexcept { return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1); }
+
+    void put_varint(std::uint64_t v) {
+        while (v >= 0x80) {
+            bytes_.push_back(static_cast<std::uint8_t>(v) | 0x80);
+            v >>= 7;
+        }
+        bytes_.push_back(static_cast<std::uint8_t>(v));
+    }
+
+    std::vector<std::size_t> offsets_;
+    std::vector<std::uint8_t> bytes_;
+};
+
+#endif //ADJACENCY_HPP
@@ -0,0 +1,241 @@
+#ifndef AGGREGATE_HPP
+#define AGGREGATE_HPP
+
+#include "graph_db.hpp"
+#include "batch.hpp"
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <type_traits>
+#include <cstdint>
+
+/**
+ * @brief Count, sum, minimum and maximum of a set of values.
+ * @tparam T The type of the values, sums of integral values are 64-bit integers and of floating values doubles.
+ */
+template <typename T>
+struct aggregate_stats {
+    using sum_t = std::conditional_t<std::is_floating_point<T>::value, double,
+                                     std::conditional_t<std::is_signed<T>::value, std::int64_t, std::uint64_t>>;
+
+    std::size_t count = 0;
+    sum_t sum = 0;
+    T min = std::numeric_limits<T>::max();
+    T max = std::numeric_limits<T>::lowest();
+
+    double mean() const noexcept { return count ? static_cast<double>(sum) / count : 0.0; }
+
+    void add(T value) noexcept {
+        ++count;
+        sum += value;
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+
+    void merge(const aggregate_stats &other) noexcept {
+        count += other.count;
+        sum += other.sum;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+};
+
+namespace aggregate_detail {
+
+constexpr std::size_t min_rows_per_thread = 1 << 14; //smaller inputs are not worth a thread
+constexpr std::size_t max_direct_keys = 1 << 16; //larger key ranges are grouped by a hash table
+
+inline std::size_t thread_count(std::size_t rows, std::size_t thrs) {
+    return std::max<std::size_t>(1, std::min(thrs, rows / min_rows_per_thread));
+}
+
+template <typename F>
+void run_chunks(std::size_t rows, std::size_t thrs, F &&f) {
+    //calls f(thread, first, last) for thrs contiguous chunks of rows
+    std::vector<std::thread> threads;
+    for (std::size_t t = 1; t < thrs; ++t)
+        threads.emplace_back([&f, t, rows, thrs] { f(t, rows * t / thrs, rows * (t + 1) / thrs); });
+    f(0, 0, rows / thrs);
+    for (auto &&th : threads)
+        th.join();
+}
+
+template <typename T>
+aggregate_stats<T> aggregate_block(const T *values, std::size_t n) {
+    //four independent accumulators break the dependency chain, so the loop vectorizes
+    using sum_t = typename aggregate_stats<T>::sum_t;
+    sum_t sum[4] = { 0, 0, 0, 0 };
+    T lo[4], hi[4];
+    std::fill(lo, lo + 4, std::numeric_limits<T>::max());
+    std::fill(hi, hi + 4, std::numeric_limits<T>::lowest());
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        for (std::size_t j = 0; j < 4; ++j) {
+            sum[j] += values[i + j];
+            lo[j] = values[i + j] < lo[j] ? values[i + j] : lo[j];
+            hi[j] = values[i + j] > hi[j] ? values[i + j] : hi[j];
+        }
+    aggregate_stats<T> s;
+    for (std::size_t j = 0; j < 4; ++j) {
+        s.sum += sum[j];
+        s.min = std::min(s.min, lo[j]);
+        s.max = std::max(s.max, hi[j]);
+    }
+    s.count = i;
+    for (; i < n; ++i)
+        s.add(values[i]);
+    return s;
+}
+
+template <typename T>
+std::pair<T, T> bounds_block(const T *values, std::size_t n) {
+    //minimum and maximum only, with the same four independent accumulators as aggregate_block
+    T lo[4], hi[4];
+    std::fill(lo, lo + 4, std::numeric_limits<T>::max());
+    std::fill(hi, hi + 4, std::numeric_limits<T>::lowest());
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        for (std::size_t j = 0; j < 4; ++j) {
+            lo[j] = values[i + j] < lo[j] ? values[i + j] : lo[j];
+            hi[j] = values[i + j] > hi[j] ? values[i + j] : hi[j];
+        }
+    for (; i < n; ++i) {
+        lo[0] = std::min(lo[0], values[i]);
+        hi[0] = std::max(hi[0], values[i]);
+    }
+    return { *std::min_element(lo, lo + 4), *std::max_element(hi, hi + 4) };
+}
+
+template <typename T>
+std::pair<T, T> bounds(column_view<T> values, std::size_t thrs) {
+    //smallest and largest value of a collumn, thrs has to come from thread_count
+    std::vector<std::pair<T, T>> partial(thrs);
+    run_chunks(values.size(), thrs, [&](std::size_t t, std::size_t first, std::size_t last) {
+        partial[t] = bounds_block(values.data() + first, last - first);
+    });
+    for (std::size_t t = 1; t < thrs; ++t) {
+        partial[0].first = std::min(partial[0].first, partial[t].first);
+        partial[0].second = std::max(partial[0].second, partial[t].second);
+    }
+    return partial[0];
+}
+
+} //namespace aggregate_detail
+
+/**
+ * @brief Aggregates a collumn, the rows are split among threads and the partial results are merged.
+ */
+template <typename T>
+aggregate_stats<T> aggregate(column_view<T> values, std::size_t thrs = std::thread::hardware_concurrency()) {
+    static_assert(std::is_arithmetic<T>::value, "Only arithmetic collumns can be aggregated");
+    thrs = aggregate_detail::thread_count(values.size(), thrs);
+    std::vector<aggregate_stats<T>> partial(thrs);
+    aggregate_detail::run_chunks(values.size(), thrs, [&](std::size_t t, std::size_t first, std::size_t last) {
+        partial[t] = aggregate_detail::aggregate_block(values.data() + first, last - first);
+    });
+    for (std::size_t t = 1; t < thrs; ++t)
+        partial[0].merge(partial[t]);
+    return partial[0];
+}
+
+/**
+ * @brief Aggregates values grouped by keys, the result holds the non-empty groups sorted by key.
+ * @note Keys of at most two bytes or with a small range of values use a direct array indexed by the key, other keys a hash table.
+ * Every thread aggregates its chunk of rows into its own partial groups, which are merged at the end.
+ */
+template <typename Key, typename T>
+std::vector<std::pair<Key, aggregate_stats<T>>> group_by(column_view<Key> keys, column_view<T> values, std::size_t thrs = std::thread::hardware_concurrency()) {
+    static_assert(std::is_arithmetic<T>::value, "Only arithmetic collumns can be aggregated");
+    std::size_t rows = std::min(keys.size(), values.size());
+    thrs = aggregate_detail::thread_count(rows, thrs);
+    std::vector<std::pair<Key, aggregate_stats<T>>> result;
+
+    //keys are offset by the smallest key in unsigned arithmetic, which wraps correctly for signed keys too
+    bool direct = false;
+    std::uint64_t base = 0;
+    std::size_t range = 0;
+    if constexpr (std::is_integral<Key>::value) {
+        if (sizeof(Key) <= 2) {
+            base = static_cast<std::uint64_t>(std::numeric_limits<Key>::min());
+            range = std::size_t(1) << (8 * sizeof(Key));
+            direct = true;
+        } else if (rows) {
+            //only the bounds, summing the keys could overflow and is not needed
+            auto bounds = aggregate_detail::bounds(keys, thrs);
+            base = static_cast<std::uint64_t>(bounds.first);
+            if (static_cast<std::uint64_t>(bounds.second) - base < aggregate_detail::max_direct_keys) {
+                range = static_cast<std::size_t>(static_cast<std::uint64_t>(bounds.second) - base) + 1;
+                direct = true;
+            }
+        }
+    }
+
+    if (direct) {
+        std::vector<std::vector<aggregate_stats<T>>> partial(thrs, std::vector<aggregate_stats<T>>(range));
+        aggregate_detail::run_chunks(rows, thrs, [&](std::size_t t, std::size_t first, std::size_t last) {
+            auto *groups = partial[t].data();
+            for (std::size_t i = first; i < last; ++i)
+                groups[static_cast<std::uint64_t>(keys[i]) - base].add(values[i]);
+        });
+        for (std::size_t k = 0; k < range; ++k) {
+            for (std::size_t t = 1; t < thrs; ++t)
+                partial[0][k].merge(partial[t][k]);
+            if (partial[0][k].count)
+                result.emplace_back(static_cast<Key>(base + k), partial[0][k]);
+        }
+        return result;
+    }
+
+    std::vector<std::unordered_map<Key, aggregate_stats<T>>> partial(thrs);
+    aggregate_detail::run_chunks(rows, thrs, [&](std::size_t t, std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i)
+            partial[t][keys[i]].add(values[i]);
+    });
+    for (std::size_t t = 1; t < thrs; ++t)
+        for (auto &&g : partial[t])
+            partial[0][g.first].merge(g.second);
+    result.assign(partial[0].begin(), partial[0].end());
+    std::sort(result.begin(), result.end(), [](auto &&a, auto &&b) { return a.first < b.first; });
+    return result;
+}
+
+/**
+ * @brief Aggregates the I-th vertex property over all vertices.
+ */
+template <std::size_t I, class GraphSchema>
+auto aggregate_vertices(const graph_db<GraphSchema> &db, std::size_t thrs = std::thread::hardware_concurrency()) {
+    auto batch = db.template get_vertex_batch<I>();
+    return aggregate(batch.template column<0>(), thrs);
+}
+
+/**
+ * @brief Groups all vertices by the Key-th property and aggregates the Value-th property in every group.
+ */
+template <std::size_t Key, std::size_t Value, class GraphSchema>
+auto group_vertices_by(const graph_db<GraphSchema> &db, std::size_t thrs = std::thread::hardware_concurrency()) {
+    auto batch = db.template get_vertex_batch<Key, Value>();
+    return group_by(batch.template column<0>(), batch.template column<1>(), thrs);
+}
+
+/**
+ * @brief Aggregates the I-th edge property over all edges.
+ */
+template <std::size_t I, class GraphSchema>
+auto aggregate_edges(const graph_db<GraphSchema> &db, std::size_t thrs = std::thread::hardware_concurrency()) {
+    auto batch = db.template get_edge_batch<I>();
+    return aggregate(batch.template column<0>(), thrs);
+}
+
+/**
+ * @brief Groups all edges by the Key-th property and aggregates the Value-th property in every group.
+ */
+template <std::size_t Key, std::size_t Value, class GraphSchema>
+auto group_edges_by(const graph_db<GraphSchema> &db, std::size_t thrs = std::thread::hardware_concurrency()) {
+    auto batch = db.template get_edge_batch<Key, Value>();
+    return group_by(batch.template column<0>(), batch.template column<1>(), thrs);
+}
+
+#endif //AGGREGATE_HPP
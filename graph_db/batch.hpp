@@ -0,0 +1,192 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <vector>
+#include <tuple>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief A read-only view of contiguous values (a C++17 stand-in for std::span<const T>).
+ */
+template <typename T>
+class column_view {
+public:
+    using value_type = T;
+    using const_iterator = const T *;
+
+    column_view() noexcept = default;
+    column_view(const T *data, std::size_t size) noexcept : data_(data), size_(size) {}
+
+    const T *data() const noexcept { return data_; }
+    std::size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    const T *begin() const noexcept { return data_; }
+    const T *end() const noexcept { return data_ + size_; }
+    const T &operator[](std::size_t i) const noexcept { return data_[i]; }
+
+    /**
+     * @brief Returns the view of n values starting at first.
+     */
+    column_view subview(std::size_t first, std::size_t n) const noexcept { return column_view(data_ + first, n); }
+
+private:
+    const T *data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+/**
+ * @brief The type of values of a batch collumn, bool is stored as char because vector<bool> has no contiguous storage.
+ */
+template <typename T>
+using batch_value_t = std::conditional_t<std::is_same<T, bool>::value, char, T>;
+
+/**
+ * @brief Query result in columnar form: internal ids, user ids and the selected property collumns of a set of rows.
+ * @tparam UserId The user id type of the rows.
+ * @tparam Props The property tuple of the rows.
+ * @tparam I Indexes of the selected properties.
+ * @note Collumns are views of the database storage when possible (all rows of a plain collumn), otherwise the batch owns a copy.
+ * Views are invalidated by any change of the database.
+ */
+template <typename UserId, typename Props, std::size_t ...I>
+class column_batch {
+public:
+    template <std::size_t K>
+    using value_t = batch_value_t<std::tuple_element_t<std::get<K>(std::make_tuple(I...)), Props>>;
+
+    column_batch(column_batch &&) = default;
+    column_batch &operator=(column_batch &&) = default;
+    //views point into the owned vectors, a copy would view the original
+    column_batch(const column_batch &) = delete;
+    column_batch &operator=(const column_batch &) = delete;
+
+    std::size_t size() const noexcept { return rows_.size(); }
+
+    /**
+     * @brief Internal ids of the rows.
+     */
+    column_view<std::size_t> rows() const noexcept { return column_view<std::size_t>(rows_.data(), rows_.size()); }
+
+    /**
+     * @brief User ids of the rows.
+     */
+    column_view<batch_value_t<UserId>> ids() const noexcept { return ids_; }
+
+    /**
+     * @brief Returns the K-th selected collumn (K indexes the I... list, not the schema).
+     */
+    template <std::size_t K>
+    column_view<value_t<K>> column() const noexcept { return std::get<K>(views_); }
+
+    /**
+     * @brief Internal ids of source and destination vertices, filled only for edge batches.
+     */
+    column_view<std::size_t> sources() const noexcept { return column_view<std::size_t>(sources_.data(), sources_.size()); }
+    column_view<std::size_t> targets() const noexcept { return column_view<std::size_t>(targets_.data(), targets_.size()); }
+
+    /**
+     * @brief Creates the batch of all rows, plain collumns are not copied.
+     */
+    template <typename Cols>
+    static column_batch all(const Cols &cols, const std::vector<UserId> &user_ids) {
+        column_batch b;
+        b.rows_.resize(user_ids.size());
+        std::iota(b.rows_.begin(), b.rows_.end(), std::size_t(0));
+        b.ids_ = b.view_all(user_ids, b.owned_ids_);
+        b.template fill_all<0>(cols);
+        return b;
+    }
+
+    /**
+     * @brief Creates the batch of the given rows, values are gathered into the batch.
+     */
+    template <typename Cols>
+    static column_batch gather(const Cols &cols, const std::vector<UserId> &user_ids, std::vector<std::size_t> rows) {
+        column_batch b;
+        b.rows_ = std::move(rows);
+        b.owned_ids_.reserve(b.rows_.size());
+        for (auto r : b.rows_)
+            b.owned_ids_.push_back(user_ids[r]);
+        b.ids_ = column_view<batch_value_t<UserId>>(b.owned_ids_.data(), b.owned_ids_.size());
+        b.template fill_rows<0>(cols);
+        return b;
+    }
+
+    /**
+     * @brief Sets source and destination collumns of an edge batch, src(row) and dst(row) return internal vertex ids.
+     */
+    template <typename Src, typename Dst>
+    void set_endpoints(Src &&src, Dst &&dst) {
+        sources_.reserve(rows_.size());
+        targets_.reserve(rows_.size());
+        for (auto r : rows_) {
+            sources_.push_back(src(r));
+            targets_.push_back(dst(r));
+        }
+    }
+
+private:
+    using owned_t = std::tuple<std::vector<batch_value_t<std::tuple_element_t<I, Props>>>...>;
+    using views_t = std::tuple<column_view<batch_value_t<std::tuple_element_t<I, Props>>>...>;
+
+    column_batch() = default;
+
+    template <typename T>
+    static column_view<batch_value_t<T>> view_all(const std::vector<T> &src, std::vector<batch_value_t<T>> &store) {
+        if constexpr (std::is_same<T, batch_value_t<T>>::value) {
+            return column_view<T>(src.data(), src.size());
+        } else {
+            store.assign(src.begin(), src.end());
+            return column_view<batch_value_t<T>>(store.data(), store.size());
+        }
+    }
+
+    template <std::size_t K, typename Cols>
+    void fill_all(const Cols &cols) {
+        if constexpr (K < sizeof...(I)) {
+            constexpr std::size_t P = std::get<K>(std::make_tuple(I...));
+            auto &store = std::get<K>(owned_);
+            if (const auto *data = cols.template data<P>()) {
+                std::get<K>(views_) = column_view<value_t<K>>(data, rows_.size());
+            } else {
+                //compressed or vector<bool> collumn, decoded block by block into the batch
+                store.resize(rows_.size());
+                cols.template scan<P>([&store](const auto *values, std::size_t n, std::size_t first) {
+                    std::copy(values, values + n, store.begin() + first);
+                });
+                std::get<K>(views_) = column_view<value_t<K>>(store.data(), store.size());
+            }
+            fill_all<K + 1>(cols);
+        }
+    }
+
+    template <std::size_t K, typename Cols>
+    void fill_rows(const Cols &cols) {
+        if constexpr (K < sizeof...(I)) {
+            constexpr std::size_t P = std::get<K>(std::make_tuple(I...));
+            auto &store = std::get<K>(owned_);
+            store.reserve(rows_.size());
+            if (const auto *data = cols.template data<P>()) {
+                for (auto r : rows_)
+                    store.push_back(data[r]);
+            } else {
+                for (auto r : rows_)
+                    store.push_back(cols.template at<P>(r));
+            }
+            std::get<K>(views_) = column_view<value_t<K>>(store.data(), store.size());
+            fill_rows<K + 1>(cols);
+        }
+    }
+
+    std::vector<std::size_t> rows_;
+    std::vector<batch_value_t<UserId>> owned_ids_;
+    column_view<batch_value_t<UserId>> ids_;
+    owned_t owned_; //gathered collumns, empty for collumns viewed in place
+    views_t views_;
+    std::vector<std::size_t> sources_, targets_;
+};
+
+#endif //BATCH_HPP
@@ -0,0 +1,390 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <functional>
+#include <utility>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <map>
+
+#include "graph_db.hpp"
+#include "intersections.hpp"
+#include "snapshot.hpp"
+#include "inline_adjacency.hpp"
+#include "aggregate.hpp"
+
+/*
+Micro benchmarks of graph_db
+usage: Bench [name]   (runs all benchmarks without a name)
+*/
+
+struct bench_schema {
+    using vertex_user_id_t = std::size_t;
+    using vertex_property_t = std::tuple<int, double, char>;
+
+    using edge_user_id_t = std::size_t;
+    using edge_property_t = std::tuple<double>;
+};
+using bench_db = graph_db<bench_schema>;
+
+template<typename F>
+double measure_ms(F &&f, int repeat = 5) {
+    //returns the best of repeated runs
+    double best = 0;
+    for (int r = 0; r < repeat; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (r == 0 || ms < best)
+            best = ms;
+    }
+    return best;
+}
+
+void fill_random(bench_db &db, std::size_t vertices, std::size_t degree, unsigned seed = 42) {
+    std::mt19937_64 rng(seed);
+    std::vector<bench_db::vertex_t> vs;
+    vs.reserve(vertices);
+    for (std::size_t i = 0; i < vertices; ++i)
+        vs.push_back(db.add_vertex(i, static_cast<int>(rng() % 100), (rng() % 1000) / 10.0, static_cast<char>('a' + rng() % 8)));
+    std::uniform_int_distribution<std::size_t> pick(0, vertices - 1);
+    for (std::size_t i = 0; i < vertices * degree; ++i)
+        db.add_edge(i, vs[pick(rng)], vs[pick(rng)], (rng() % 1000) / 100.0);
+}
+
+std::size_t sum_neighbours(const bench_db &db) {
+    std::size_t sum = 0;
+    auto[vertexes_begin, vertexes_end] = db.get_vertexes();
+    for (auto it = vertexes_begin; it != vertexes_end; ++it) {
+        auto[neigbor_edges_begin, neighbor_edges_end] = (*it).edges();
+        for (auto e = neigbor_edges_begin; e != neighbor_edges_end; ++e)
+            sum += (*e).dst().id();
+    }
+    return sum;
+}
+
+void bench_adjacency() {
+    //decode cost of compacted adjacency vs memory saved
+    bench_db db;
+    fill_random(db, 200000, 16);
+
+    std::size_t plain_sum = 0, compact_sum = 0;
+    auto plain_bytes = db.memory_usage().neighbours.total();
+    double plain_ms = measure_ms([&] { plain_sum = sum_neighbours(db); });
+
+    db.compact_adjacency();
+    auto compact_bytes = db.memory_usage().neighbours.total();
+    double compact_ms = measure_ms([&] { compact_sum = sum_neighbours(db); });
+
+    std::cout << "adjacency plain:   " << plain_bytes << " B, " << plain_ms << " ms\n";
+    std::cout << "adjacency compact: " << compact_bytes << " B, " << compact_ms << " ms"
+              << (plain_sum == compact_sum ? "" : " MISMATCH") << "\n";
+}
+
+void bench_intersections() {
+    //common neighbours through std::set copies vs sorted neighbour index
+    bench_db db;
+    fill_random(db, 20000, 32);
+    std::vector<bench_db::vertex_t> vs;
+    auto[vertexes_begin, vertexes_end] = db.get_vertexes();
+    for (auto it = vertexes_begin; it != vertexes_end; ++it)
+        vs.push_back(*it);
+
+    std::mt19937_64 rng(7);
+    std::vector<std::pair<std::size_t, std::size_t>> pairs;
+    for (int i = 0; i < 20000; ++i)
+        pairs.emplace_back(rng() % vs.size(), rng() % vs.size());
+
+    auto dst_set = [](const bench_db::vertex_t &v) {
+        std::set<std::size_t> ids;
+        auto[neigbor_edges_begin, neighbor_edges_end] = v.edges();
+        for (auto e = neigbor_edges_begin; e != neighbor_edges_end; ++e)
+            ids.insert((*e).dst().id());
+        return ids;
+    };
+
+    std::size_t set_common = 0, index_common = 0;
+    double set_ms = measure_ms([&] {
+        set_common = 0;
+        for (auto &&p : pairs) {
+            auto a = dst_set(vs[p.first]), b = dst_set(vs[p.second]);
+            for (auto id : a)
+                set_common += b.count(id);
+        }
+    }, 1);
+
+    db.sort_adjacency();
+    std::unique_ptr<neighbour_index<bench_schema>> index;
+    double build_ms = measure_ms([&] { index = std::make_unique<neighbour_index<bench_schema>>(db, false); }, 1);
+    double index_ms = measure_ms([&] {
+        index_common = 0;
+        for (auto &&p : pairs)
+            index_common += index->common_neighbours(vs[p.first], vs[p.second]);
+    });
+
+    std::uint64_t triangles = 0;
+    neighbour_index<bench_schema> undirected(db);
+    double triangle_ms = measure_ms([&] { triangles = undirected.count_triangles(); }, 1);
+
+    std::cout << "common neighbours std::set: " << set_ms << " ms\n";
+    std::cout << "common neighbours index:    " << index_ms << " ms (+" << build_ms << " ms build)"
+              << (set_common == index_common ? "" : " MISMATCH") << "\n";
+    std::cout << "triangles: " << triangles << " in " << triangle_ms << " ms\n";
+}
+
+void bench_inline_adjacency() {
+    //weighted traversal through neighbor_it_t + edge collumns vs inline weights
+    bench_db db;
+    fill_random(db, 200000, 16);
+    double plain_sum = 0, inline_sum = 0;
+    double plain_ms = measure_ms([&] {
+        plain_sum = 0;
+        auto[vertexes_begin, vertexes_end] = db.get_vertexes();
+        for (auto it = vertexes_begin; it != vertexes_end; ++it) {
+            auto[neigbor_edges_begin, neighbor_edges_end] = (*it).edges();
+            for (auto e = neigbor_edges_begin; e != neighbor_edges_end; ++e)
+                plain_sum += (*e).get_property<0>();
+        }
+    });
+
+    inline_adjacency<bench_schema, 0> weighted(db);
+    double inline_ms = measure_ms([&] {
+        inline_sum = 0;
+        for (std::size_t v = 0; v < weighted.vertex_count(); ++v) {
+            auto[first, last] = weighted.neighbours(v);
+            for (auto e = first; e != last; ++e)
+                inline_sum += e->get<0>();
+        }
+    });
+    std::cout << "weighted traversal neighbor_it_t: " << plain_ms << " ms\n";
+    std::cout << "weighted traversal inline:        " << inline_ms << " ms" << (plain_sum == inline_sum ? "" : " MISMATCH") << "\n";
+}
+
+void bench_aggregate() {
+    //mean of the double property grouped by the char property, std::map over vertices vs collumn group_by
+    bench_db db;
+    fill_random(db, 2000000, 0);
+    std::map<char, std::pair<double, std::size_t>> groups;
+    double map_ms = measure_ms([&] {
+        groups.clear();
+        auto[vertexes_begin, vertexes_end] = db.get_vertexes();
+        for (auto it = vertexes_begin; it != vertexes_end; ++it) {
+            auto &g = groups[(*it).get_property<2>()];
+            g.first += (*it).get_property<1>();
+            ++g.second;
+        }
+    });
+    std::size_t group_count = 0;
+    double group_ms = measure_ms([&] { group_count = group_vertices_by<2, 1>(db).size(); });
+    double sum_ms = measure_ms([&] { aggregate_vertices<1>(db); });
+    std::cout << "group by std::map: " << map_ms << " ms\n";
+    std::cout << "group by collumns: " << group_ms << " ms" << (group_count == groups.size() ? "" : " MISMATCH") << "\n";
+    std::cout << "sum/min/max collumn: " << sum_ms << " ms\n";
+}
+
+struct temporal_schema {
+    using vertex_user_id_t = std::size_t;
+    using vertex_property_t = std::tuple<int>;
+
+    using edge_user_id_t = std::size_t;
+    using edge_property_t = std::tuple<double, long>;
+    static constexpr std::size_t edge_timestamp_index = 1;
+};
+
+void bench_temporal() {
+    //neighbours active in a window: filtering the whole adjacency vs edges_between
+    graph_db<temporal_schema> db;
+    std::mt19937_64 rng(3);
+    const std::size_t vertices = 100000, degree = 32;
+    std::vector<graph_db<temporal_schema>::vertex_t> vs;
+    for (std::size_t i = 0; i < vertices; ++i)
+        vs.push_back(db.add_vertex(i, 0));
+    for (std::size_t i = 0; i < vertices * degree; ++i)
+        db.add_edge(i, vs[rng() % vertices], vs[rng() % vertices], 1.0, static_cast<long>(rng() % 1000000));
+
+    const long t0 = 500000, t1 = 510000;
+    std::size_t scan_count = 0, window_count = 0;
+    double scan_ms = measure_ms([&] {
+        scan_count = 0;
+        for (auto &&v : vs) {
+            auto[neigbor_edges_begin, neighbor_edges_end] = v.edges();
+            for (auto e = neigbor_edges_begin; e != neighbor_edges_end; ++e) {
+                long t = (*e).get_property<1>();
+                scan_count += t >= t0 && t <= t1;
+            }
+        }
+    });
+    double sort_ms = measure_ms([&] { for (auto &&v : vs) v.edges_between(t0, t1); }, 1);
+    double window_ms = measure_ms([&] {
+        window_count = 0;
+        for (auto &&v : vs) {
+            auto[begin, end] = v.edges_between(t0, t1);
+            for (auto e = begin; e != end; ++e)
+                ++window_count;
+        }
+    });
+    std::cout << "window by scan:          " << scan_ms << " ms\n";
+    std::cout << "window by edges_between: " << window_ms << " ms (+" << sort_ms << " ms first sort)"
+              << (scan_count == window_count ? "" : " MISMATCH") << "\n";
+}
+
+void bench_pipeline() {
+    //weights of edges from vertices with a large int property: staged vectors vs nested loops vs fused pipeline
+    bench_db db;
+    fill_random(db, 200000, 16);
+    double staged_sum = 0, loop_sum = 0, pipeline_sum = 0;
+    double staged_ms = measure_ms([&] {
+        std::vector<bench_db::vertex_t> selected;
+        auto[vertexes_begin, vertexes_end] = db.get_vertexes();
+        for (auto it = vertexes_begin; it != vertexes_end; ++it)
+            if ((*it).get_property<0>() > 50)
+                selected.push_back(*it);
+        std::vector<bench_db::edge_t> edges;
+        for (auto &&v : selected) {
+            auto[neigbor_edges_begin, neighbor_edges_end] = v.edges();
+            for (auto e = neigbor_edges_begin; e != neighbor_edges_end; ++e)
+                edges.push_back(*e);
+        }
+        staged_sum = 0;
+        for (auto &&e : edges)
+            staged_sum += e.get_property<0>();
+    });
+    double loop_ms = measure_ms([&] {
+        loop_sum = 0;
+        auto[vertexes_begin, vertexes_end] = db.get_vertexes();
+        for (auto it = vertexes_begin; it != vertexes_end; ++it) {
+            if ((*it).get_property<0>() <= 50)
+                continue;
+            auto[neigbor_edges_begin, neighbor_edges_end] = (*it).edges();
+            for (auto e = neigbor_edges_begin; e != neighbor_edges_end; ++e)
+                loop_sum += (*e).get_property<0>();
+        }
+    });
+    using namespace traversal;
+    double pipeline_ms = measure_ms([&] { pipeline_sum = (db.vertices() | where<0>(gt(50)) | expand() | select<0>()).sum(); });
+    std::cout << "staged vectors: " << staged_ms << " ms\n";
+    std::cout << "nested loops:   " << loop_ms << " ms\n";
+    std::cout << "pipeline:       " << pipeline_ms << " ms"
+              << (staged_sum == loop_sum && loop_sum == pipeline_sum ? "" : " MISMATCH") << "\n";
+}
+
+struct soa_schema {
+    using vertex_user_id_t = std::size_t;
+    using vertex_property_t = std::tuple<int, double, long, float>;
+
+    using edge_user_id_t = std::size_t;
+    using edge_property_t = std::tuple<double>;
+};
+
+struct aos_schema : soa_schema {
+    using vertex_property_groups = property_groups<std::index_sequence<0, 1, 2, 3>>;
+};
+
+template <class Schema>
+void bench_layout_of(const char *name) {
+    graph_db<Schema> db;
+    const std::size_t vertices = 2000000;
+    std::vector<typename graph_db<Schema>::vertex_t> vs;
+    vs.reserve(vertices);
+    for (std::size_t i = 0; i < vertices; ++i)
+        vs.push_back(db.add_vertex(i, static_cast<int>(i % 100), 0.5 * i, static_cast<long>(i), 1.0f));
+    std::mt19937_64 rng(5);
+    std::vector<std::size_t> order(vertices);
+    for (auto &&r : order)
+        r = rng() % vertices;
+    double row_sum = 0;
+    double rows_ms = measure_ms([&] {
+        row_sum = 0;
+        for (auto r : order) {
+            auto[a, b, c, d] = vs[r].get_properties();
+            row_sum += a + b + c + d;
+        }
+    });
+    double scan_ms = measure_ms([&] { aggregate_vertices<1>(db); });
+    std::cout << name << " random rows: " << rows_ms << " ms, collumn aggregate: " << scan_ms << " ms (" << row_sum << ")\n";
+}
+
+void bench_layout() {
+    //whole rows at random vs one collumn scanned, collumn per property vs one group of all four
+    bench_layout_of<soa_schema>("collumns");
+    bench_layout_of<aos_schema>("grouped ");
+}
+
+void bench_sketches() {
+    //ingest cost of the sketches and in-degree heavy hitters by a full edge scan vs the count-min sketch
+    const std::size_t vertices = 200000, degree = 16;
+    for (bool sketches : { false, true }) {
+        double ingest_ms = measure_ms([&] {
+            bench_db db;
+            if (sketches)
+                db.enable_sketches();
+            fill_random(db, vertices, degree);
+        }, 1);
+        std::cout << (sketches ? "ingest with sketches: " : "ingest plain:         ") << ingest_ms << " ms\n";
+    }
+    bench_db db;
+    db.enable_sketches();
+    fill_random(db, vertices, degree);
+    std::size_t top = 0;
+    double scan_ms = measure_ms([&] {
+        std::vector<std::size_t> in(vertices);
+        auto[edges_begin, edges_end] = db.get_edges();
+        for (auto e = edges_begin; e != edges_end; ++e)
+            ++in[(*e).dst().id()];
+        top = 0;
+        for (std::size_t v = 1; v < vertices; ++v)
+            top = in[v] > in[top] ? v : top;
+    });
+    std::size_t hits = 0;
+    double sketch_ms = measure_ms([&] { hits = db.heavy_vertices(0.0).size(); });
+    std::cout << "top in-degree by scan:  " << scan_ms << " ms (vertex " << top << ")\n";
+    std::cout << "heavy_vertices:         " << sketch_ms << " ms (" << hits << " candidates)\n";
+    std::cout << "median out-degree:      " << db.degree_quantile(0.5) << ", sketches " << db.sketches()->bytes() << " B\n";
+}
+
+void bench_snapshot() {
+    //checkpoint and restore time with and without block compression
+    bench_db db;
+    fill_random(db, 200000, 16);
+    for (bool compress : { false, true }) {
+        snapshot_options opt;
+        opt.compress = compress;
+        std::string bytes;
+        double save_ms = measure_ms([&] {
+            std::ostringstream out;
+            snapshot<bench_schema>::save(db, out, opt);
+            bytes = out.str();
+        }, 1);
+        double load_ms = measure_ms([&] {
+            bench_db copy;
+            std::istringstream in(bytes);
+            snapshot<bench_schema>::load(copy, in);
+        }, 1);
+        std::cout << (compress ? "snapshot lz:    " : "snapshot plain: ") << bytes.size() << " B, save "
+                  << save_ms << " ms, load " << load_ms << " ms\n";
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<std::pair<std::string, std::function<void()>>> benches = {
+        { "adjacency", bench_adjacency },
+        { "intersections", bench_intersections },
+        { "inline_adjacency", bench_inline_adjacency },
+        { "aggregate", bench_aggregate },
+        { "temporal", bench_temporal },
+        { "pipeline", bench_pipeline },
+        { "layout", bench_layout },
+        { "sketches", bench_sketches },
+        { "snapshot", bench_snapshot },
+    };
+    for (auto &&b : benches) {
+        if (argc < 2 || b.first == argv[1]) {
+            std::cout << "== " << b.first << "\n";
+            b.second();
+        }
+    }
+    return 0;
+}
@@ -1,14 +1,73 @@
 #ifndef COLLUMNS_HPP
 #define COLLUMNS_HPP
 
+#include "packed_column.hpp"
+#include "memory.hpp"
+
 #include <vector>
 #include <tuple>
+#include <array>
+#include <utility>
+#include <type_traits>
+#include <memory>
+
+/**
+ * @brief Layout of a property table: every listed group of property indexes is stored as one array of structs (row tuples),
+ * properties not listed in any group keep their own collumn (struct of arrays).
+ * @note A schema picks it by using vertex_property_groups = property_groups<std::index_sequence<0, 1>, ...>; (edge_property_groups for edges).
+ * Group properties read together (e.g. by get_properties()) so a row touches one cache line instead of one per collumn.
+ * Grouped properties cannot be compressed and are copied when read as a collumn (scan, batches).
+ */
+template <typename ...Groups>
+struct property_groups {
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    template <std::size_t I>
+    static constexpr std::size_t group_of() {
+        //index of the group containing property I, npos for a plain collumn
+        constexpr bool contains[] = { false, contains_property<I>(Groups{})... };
+        for (std::size_t g = 0; g < sizeof...(Groups); ++g)
+            if (contains[g + 1])
+                return g;
+        return npos;
+    }
+
+    template <std::size_t I>
+    static constexpr std::size_t position_of() {
+        //position of property I inside its group
+        constexpr std::size_t positions[] = { 0, position_in_group<I>(Groups{})... };
+        return positions[group_of<I>() + 1];
+    }
+
+private:
+    template <std::size_t I, std::size_t ...J>
+    static constexpr bool contains_property(std::index_sequence<J...>) { return ((I == J) || ... || false); }
 
-template <class C, typename T2>
+    template <std::size_t I, std::size_t ...J>
+    static constexpr std::size_t position_in_group(std::index_sequence<J...>) {
+        constexpr std::size_t members[] = { J..., I };
+        std::size_t p = 0;
+        while (members[p] != I)
+            ++p;
+        return p;
+    }
+};
+
+template <class GraphSchema, typename = void>
+struct vertex_layout { using type = property_groups<>; };
+template <class GraphSchema>
+struct vertex_layout<GraphSchema, std::void_t<typename GraphSchema::vertex_property_groups>> { using type = typename GraphSchema::vertex_property_groups; };
+
+template <class GraphSchema, typename = void>
+struct edge_layout { using type = property_groups<>; };
+template <class GraphSchema>
+struct edge_layout<GraphSchema, std::void_t<typename GraphSchema::edge_property_groups>> { using type = typename GraphSchema::edge_property_groups; };
+
+template <class C, typename T2, typename Layout = property_groups<>>
 class columns;
 
-template <class GraphSchema, typename ...Props>
-class columns<GraphSchema, std::tuple<Props...>> {
+template <class GraphSchema, typename ...Props, typename ...Groups>
+class columns<GraphSchema, std::tuple<Props...>, property_groups<Groups...>> {
 
 public:
 
@@ -16,17 +75,18 @@ public:
         //used for initializing new vertex/edge to create empty row
         append_empty_props(std::make_index_sequence<sizeof...(Props)>{});
     }
-    
+
     template <std::size_t ...I>
     auto get_properties(std::size_t row, std::index_sequence<I...>) const noexcept {
-        //return row from table
-        return std::make_tuple(std::get<I>(properties_)[row]...);
+        //return row from table, cold collumns are read without decompressing them
+        return std::make_tuple(value<I>(row)...);
     }
 
     template<std::size_t I>
     decltype(auto) get_property(std::size_t row){
-        //returns property from in given collumn from given row
-        return std::get<I>(properties_)[row];
+        //returns property from in given collumn from given row, a reference needs the plain collumn
+        thaw<I>();
+        return slot<I>(row);
     }
 
     template <std::size_t ...I, typename ...Ts>
@@ -39,25 +99,245 @@ public:
 
     template<std::size_t I, typename PropType>
     void assign_property(std::size_t row, const PropType &prop)  noexcept {
-        std::get<I>(properties_)[row] = prop;
+        thaw<I>();
+        slot<I>(row) = prop;
+    }
+
+    std::array<std::size_t, sizeof...(Props)> column_bytes() const noexcept {
+        //returns allocated bytes of every collumn
+        return column_bytes(std::make_index_sequence<sizeof...(Props)>{});
+    }
+
+    std::array<memory_entry, sizeof...(Props)> memory_usage() const noexcept {
+        //returns memory breakdown of every collumn, a group is reported by its first property
+        return memory_usage(std::make_index_sequence<sizeof...(Props)>{});
+    }
+
+    template<std::size_t I>
+    void compress() {
+        //moves collumn into its compressed form and releases the plain vector
+        static_assert(packed_t<I>::supported, "Only integral collumns can be compressed");
+        static_assert(!grouped<I>(), "Grouped properties cannot be compressed");
+        if (std::get<I>(cold_).empty() && !std::get<I>(properties_).empty()) {
+            std::get<I>(cold_).pack(std::get<I>(properties_));
+            std::vector<std::tuple_element_t<I, std::tuple<Props...>>>().swap(std::get<I>(properties_));
+        }
+    }
+
+    template<std::size_t I>
+    void assign_column(std::vector<std::tuple_element_t<I, std::tuple<Props...>>> &&values) {
+        //replaces the whole collumn, grouped rows are resized to the collumn
+        if constexpr (grouped<I>()) {
+            auto &rows = group<I>();
+            rows.resize(values.size());
+            for (std::size_t row = 0; row < values.size(); ++row)
+                std::get<position<I>()>(rows[row]) = std::move(values[row]);
+        } else {
+            std::get<I>(cold_).clear();
+            std::get<I>(properties_) = std::move(values);
+        }
+    }
+
+    void keep_rows(const std::vector<char> &keep) {
+        //removes rows whose keep flag is 0, compressed collumns are decompressed
+        keep_rows(keep, std::make_index_sequence<sizeof...(Props)>{});
+    }
+
+    void clear() noexcept {
+        //removes all rows
+        properties_ = std::tuple<std::vector<Props>...>();
+        cold_ = std::tuple<packed_column<Props>...>();
+        groups_ = groups_t();
+    }
+
+    template<std::size_t I>
+    bool compressed() const noexcept {
+        return !std::get<I>(cold_).empty();
+    }
+
+    template<std::size_t I>
+    const auto *data() const noexcept {
+        //returns plain storage of the collumn, nullptr if it is compressed, grouped or has no contiguous storage (vector<bool>)
+        using T = std::tuple_element_t<I, std::tuple<Props...>>;
+        if constexpr (std::is_same<T, bool>::value)
+            return static_cast<const char *>(nullptr);
+        else if constexpr (grouped<I>())
+            return static_cast<const T *>(nullptr);
+        else
+            return std::get<I>(cold_).empty() ? std::get<I>(properties_).data() : nullptr;
+    }
+
+    template<std::size_t I>
+    auto at(std::size_t row) const {
+        //returns a copy of the value, cold collumns are read without decompressing them
+        return value<I>(row);
+    }
+
+    template<std::size_t I>
+    void thaw() {
+        //decompresses cold collumn back into plain vector, called before a reference into it is handed out
+        if constexpr (packed_t<I>::supported) {
+            if (!std::get<I>(cold_).empty()) {
+                std::get<I>(cold_).unpack(std::get<I>(properties_));
+                std::get<I>(cold_).clear();
+            }
+        }
+    }
+
+    template<std::size_t I, typename F>
+    void scan(F &&f) const {
+        //calls f(const T *values, std::size_t n, std::size_t first_row) block by block, cold collumns are decompressed on the fly
+        using T = std::tuple_element_t<I, std::tuple<Props...>>;
+        const auto &col = std::get<I>(properties_);
+        if constexpr (packed_t<I>::supported) {
+            if (!std::get<I>(cold_).empty()) {
+                std::get<I>(cold_).for_each_block(f);
+                return;
+            }
+        }
+        if constexpr (grouped<I>()) {
+            //rows of a group are gathered into a buffer
+            const auto &rows = group<I>();
+            constexpr std::size_t block = packed_column<bool>::block_size;
+            std::unique_ptr<T[]> buffer(new T[block]);
+            for (std::size_t first = 0; first < rows.size(); first += block) {
+                std::size_t n = std::min(block, rows.size() - first);
+                for (std::size_t i = 0; i < n; ++i)
+                    buffer[i] = std::get<position<I>()>(rows[first + i]);
+                f(static_cast<const T *>(buffer.get()), n, first);
+            }
+        } else if constexpr (std::is_same<T, bool>::value) {
+            //vector<bool> has no contiguous storage
+            std::array<bool, packed_column<bool>::block_size> buffer;
+            for (std::size_t first = 0; first < col.size(); first += buffer.size()) {
+                std::size_t n = std::min(buffer.size(), col.size() - first);
+                std::copy(col.begin() + first, col.begin() + first + n, buffer.begin());
+                f(buffer.data(), n, first);
+            }
+        } else if (!col.empty()) {
+            f(col.data(), col.size(), std::size_t(0));
+        }
     }
 
 private:
-    std::tuple<std::vector<Props>...> properties_;
+    template<std::size_t I>
+    using packed_t = packed_column<std::tuple_element_t<I, std::tuple<Props...>>>;
+
+    using layout_t = property_groups<Groups...>;
+
+    template<typename Group>
+    struct group_row;
+    template<std::size_t ...J>
+    struct group_row<std::index_sequence<J...>> { using type = std::tuple<std::tuple_element_t<J, std::tuple<Props...>>...>; };
+
+    using groups_t = std::tuple<std::vector<typename group_row<Groups>::type>...>;
+
+    template<std::size_t I>
+    static constexpr bool grouped() { return layout_t::template group_of<I>() != layout_t::npos; }
+    template<std::size_t I>
+    static constexpr std::size_t position() { return layout_t::template position_of<I>(); }
+
+    std::tuple<std::vector<Props>...> properties_; //plain collumns, empty for grouped properties
+    std::tuple<packed_column<Props>...> cold_; //compressed collumns, a collumn is either in properties_ or in cold_
+    groups_t groups_; //row tuples of every property group
+
+    template <std::size_t I>
+    auto &group() { return std::get<layout_t::template group_of<I>()>(groups_); }
+    template <std::size_t I>
+    const auto &group() const { return std::get<layout_t::template group_of<I>()>(groups_); }
+
+    template <std::size_t I>
+    decltype(auto) slot(std::size_t row) {
+        //reference to the value in its collumn or group row
+        if constexpr (grouped<I>())
+            return (std::get<position<I>()>(group<I>()[row]));
+        else
+            return std::get<I>(properties_)[row];
+    }
+    template <std::size_t I>
+    decltype(auto) slot(std::size_t row) const {
+        if constexpr (grouped<I>())
+            return (std::get<position<I>()>(group<I>()[row]));
+        else
+            return std::get<I>(properties_)[row];
+    }
 
     template <std::size_t ...I>
     void append_empty_props(std::index_sequence<I...>) noexcept {
         //creates empty row
-        ( std::get<I>(properties_).emplace_back(), ... );
+        ( thaw<I>(), ... );
+        ( append_empty_column<I>(), ... );
+        std::apply([](auto &...rows) { ( rows.emplace_back(), ... ); }, groups_);
+    }
+
+    template <std::size_t I>
+    void append_empty_column() {
+        if constexpr (!grouped<I>())
+            std::get<I>(properties_).emplace_back();
+    }
+
+    template <std::size_t I>
+    auto value(std::size_t row) const {
+        if constexpr (packed_t<I>::supported) {
+            if (!std::get<I>(cold_).empty())
+                return std::get<I>(cold_).at(row);
+        }
+        return std::tuple_element_t<I, std::tuple<Props...>>(slot<I>(row));
+    }
+
+    template <std::size_t I>
+    std::size_t column_bytes() const noexcept {
+        if constexpr (grouped<I>())
+            return layout_t::template position_of<I>() ? 0 : group<I>().capacity() * sizeof(typename std::decay_t<decltype(group<I>())>::value_type);
+        else
+            return std::get<I>(properties_).capacity() * sizeof(std::tuple_element_t<I, std::tuple<Props...>>) + std::get<I>(cold_).bytes();
+    }
+
+    template <std::size_t ...I>
+    std::array<std::size_t, sizeof...(Props)> column_bytes(std::index_sequence<I...>) const noexcept {
+        return { column_bytes<I>()... };
+    }
+
+    template <std::size_t I>
+    memory_entry column_usage() const noexcept {
+        if constexpr (grouped<I>()) {
+            return position<I>() ? memory_entry() : vector_usage(group<I>());
+        } else {
+            memory_entry usage = vector_usage(std::get<I>(properties_));
+            usage.compressed_bytes = std::get<I>(cold_).bytes();
+            return usage;
+        }
+    }
+
+    template <std::size_t ...I>
+    std::array<memory_entry, sizeof...(Props)> memory_usage(std::index_sequence<I...>) const noexcept {
+        return { column_usage<I>()... };
+    }
+
+    template <std::size_t ...I>
+    void keep_rows(const std::vector<char> &keep, std::index_sequence<I...>) {
+        ( thaw<I>(), ... );
+        ( keep_column(std::get<I>(properties_), keep), ... );
+        std::apply([&keep](auto &...rows) { ( keep_column(rows, keep), ... ); }, groups_);
+    }
+
+    template <typename Vec>
+    static void keep_column(Vec &col, const std::vector<char> &keep) {
+        std::size_t out = 0;
+        for (std::size_t row = 0; row < col.size(); ++row)
+            if (keep[row])
+                col[out++] = std::move(col[row]);
+        col.resize(out);
     }
 
     template <std::size_t I, typename T>
     void assign(std::size_t row, T &&src) noexcept {
         //helper function called from assign_properties function for setting values into specified row
-        std::get<I>(properties_)[row] = src;
+        thaw<I>();
+        slot<I>(row) = src;
     }
 
 };
 
 
-#endif //COLLUMNS_HPP
\ No newline at end of file
+#endif //COLLUMNS_HPP
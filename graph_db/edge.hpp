@@ -28,6 +28,7 @@ public:
      */
     auto get_properties() const{
         //return properties returned from function specified in collumns.hpp
+        db_->stats_.edge_get_all();
         return db_->edge_cols_.get_properties(internal_id_, std::make_index_sequence<std::tuple_size<typename GraphSchema::edge_property_t>::value>{});
     }
 
@@ -36,14 +37,27 @@ public:
      * @brief Returns a single immutable property of the I-th element.
      * @tparam I An index of the property.
      * @return The value of the property.
-     * @note The first property is on index 0.
+     * @note The first property is on index 0. The value is returned by reference, so a compressed collumn is decompressed first.
+     * @see read_property
      */
     template<size_t I>
     decltype(auto) get_property() const{
         //return property returned from function specified in collumns.hpp
+        db_->stats_.template edge_get<I>();
         return db_->edge_cols_.template get_property<I>(internal_id_);
     }
 
+    /**
+     * @brief Returns a copy of a single property of the I-th element.
+     * @tparam I An index of the property.
+     * @note Unlike get_property it reads a compressed collumn in place, so concurrent readers can use it.
+     */
+    template<size_t I>
+    auto read_property() const{
+        db_->stats_.template edge_get<I>();
+        return db_->edge_cols_.template at<I>(internal_id_);
+    }
+
     /**
      * @brief Sets the values of properties of the element.
      * @tparam PropsType Types of the properties.
@@ -54,7 +68,9 @@ public:
     void set_properties(PropsType &&...props){
         //sets properties using function specified in collumns.hpp
         auto index_seq = std::make_index_sequence<std::tuple_size<typename GraphSchema::edge_property_t>::value>{};
-        return db_->edge_cols_.assign_properties(internal_id_, index_seq, std::forward<PropsType>(props)...);
+        db_->stats_.edge_set_all();
+        db_->edge_cols_.assign_properties(internal_id_, index_seq, std::forward<PropsType>(props)...);
+        db_->timestamp_changed(internal_id_);
     }
 
     /**
@@ -67,7 +83,9 @@ public:
     template<size_t I, typename PropType>
     void set_property(const PropType &prop){
         //sets property using function specified in collumns.hpp
-        return db_->edge_cols_.template assign_property<I>(internal_id_, prop);
+        db_->stats_.template edge_set<I>();
+        db_->edge_cols_.template assign_property<I>(internal_id_, prop);
+        db_->template edge_property_changed<I>(internal_id_);
     }
 
     /**
@@ -5,11 +5,20 @@
 #include "vertex.hpp"
 #include "collumns.hpp"
 #include "iterators.hpp"
+#include "stats.hpp"
+#include "memory.hpp"
+#include "adjacency.hpp"
+#include "batch.hpp"
+#include "temporal.hpp"
+#include "pipeline.hpp"
+#include "sketches.hpp"
 
 
 #include <vector>
 #include <tuple>
 #include <utility>
+#include <algorithm>
+#include <memory>
 
 template <class GraphSchema>
 class edge;
@@ -20,13 +29,27 @@ class graph_db;
 template <class GraphSchema>
 class edge;
 
-template <class C, typename T2>
+template <class C, typename T2, typename Layout>
 class columns;
 
 template <class GraphSchema, typename T>
 class my_iterator;
 template <typename Ret, class GraphSchema>
 class neighbour_iterator;
+template <class GraphSchema>
+class neighbour_index;
+template <class GraphSchema>
+class subgraph_view;
+template <class GraphSchema>
+class snapshot;
+template <class GraphSchema, typename State, typename Message>
+class pregel;
+template <class GraphSchema, std::size_t ...I>
+class inline_adjacency;
+template <class GraphSchema>
+class partitioner;
+template <class GraphSchema>
+class sharded_graph;
 
 
 /**
@@ -66,6 +89,20 @@ public:
      */
     using neighbor_it_t = neighbour_iterator<edge<GraphSchema>, GraphSchema>;
 
+    /**
+     * @brief A type representing a columnar result of vertex rows with the I-th vertex properties.
+     * @see column_batch
+     */
+    template<std::size_t ...I>
+    using vertex_batch_t = column_batch<typename GraphSchema::vertex_user_id_t, typename GraphSchema::vertex_property_t, I...>;
+
+    /**
+     * @brief A type representing a columnar result of edge rows with the I-th edge properties.
+     * @see column_batch
+     */
+    template<std::size_t ...I>
+    using edge_batch_t = column_batch<typename GraphSchema::edge_user_id_t, typename GraphSchema::edge_property_t, I...>;
+
     /**
      * @brief Insert a vertex into the database.
      * @param vuid A user id of the newly created vertex.
@@ -74,6 +111,8 @@ public:
      */
     vertex_t add_vertex(typename GraphSchema::vertex_user_id_t &&vuid)
     {
+        auto timer = stats_.time_add_vertex();
+        expand_adjacency();
 
         vertex_user_ids_.push_back(vuid);
         vertex_cols_.append_empty();
@@ -82,12 +121,18 @@ public:
 
         vertices_.push_back(v);
         neighbours_.emplace_back();
+        if constexpr (timestamp_t::enabled)
+            time_sorted_.push_back(0);
+        if (sketches_)
+            sketches_->vertex_added();
         
         return v;
 
     }
     vertex_t add_vertex(const typename GraphSchema::vertex_user_id_t &vuid)
     {
+        auto timer = stats_.time_add_vertex();
+        expand_adjacency();
         vertex_user_ids_.push_back(vuid);
         vertex_cols_.append_empty();
         vertex_t v(vertex_user_ids_.size()-1, this);
@@ -95,6 +140,10 @@ public:
 
         vertices_.push_back(v);
         neighbours_.emplace_back();
+        if constexpr (timestamp_t::enabled)
+            time_sorted_.push_back(0);
+        if (sketches_)
+            sketches_->vertex_added();
         
         return v;
     }
@@ -142,25 +191,37 @@ public:
      */
     edge_t add_edge(typename GraphSchema::edge_user_id_t &&euid, const vertex_t &v1, const vertex_t &v2)
     {
+        auto timer = stats_.time_add_edge();
+        expand_adjacency();
         edge_user_ids_.push_back(euid);
         edge_cols_.append_empty();
         edge_t e(edge_user_ids_.size()-1, v1.internal_id_, v2.internal_id_, this);
         //edge_added(e);
 
         edges_.push_back(e);
-        neighbours_[e.src_id_].push_back(e.internal_id_);
+        keep_sorted(e);
+        stats_.push_adjacency(neighbours_[e.src_id_], e.internal_id_);
+        timestamp_changed(e.internal_id_);
+        if (sketches_)
+            sketches_->edge_added(e.src_id_, e.dst_id_);
         //(vertices_[e.src_id_]).neighbours_.push_back(e.internal_id_);
         return e;
     }
     edge_t add_edge(const typename GraphSchema::edge_user_id_t &euid, const vertex_t &v1, const vertex_t &v2)
     {
+        auto timer = stats_.time_add_edge();
+        expand_adjacency();
         edge_user_ids_.push_back(euid);
         edge_cols_.append_empty();
         edge_t e(edge_user_ids_.size()-1, v1.internal_id_, v2.internal_id_, this);
         //edge_added(e);
 
         edges_.push_back(e);
-        neighbours_[e.src_id_].push_back(e.internal_id_);
+        keep_sorted(e);
+        stats_.push_adjacency(neighbours_[e.src_id_], e.internal_id_);
+        timestamp_changed(e.internal_id_);
+        if (sketches_)
+            sketches_->edge_added(e.src_id_, e.dst_id_);
 
         //(vertices_[e.src_id_]).neighbours_.push_back(e.internal_id_);
 
@@ -202,24 +263,574 @@ public:
         );
     }
 
+    /**
+     * @brief Returns a lazy pipeline over all vertexes, e.g. db.vertices() | where<0>(gt(10)) | expand().
+     * @see traversal::pipeline
+     */
+    auto vertices() const
+    {
+        return traversal::from(get_vertexes());
+    }
+
+    /**
+     * @brief Returns a lazy pipeline over all edges.
+     * @see traversal::pipeline
+     */
+    auto edges() const
+    {
+        return traversal::from(get_edges());
+    }
+
+    /**
+     * @brief Returns ids and the I-th property collumns of all vertexes.
+     * @note Plain collumns are viewed in place, compressed ones are decoded into the batch. The batch is invalidated by any change of the database.
+     */
+    template<std::size_t ...I>
+    vertex_batch_t<I...> get_vertex_batch() const
+    {
+        return vertex_batch_t<I...>::all(vertex_cols_, vertex_user_ids_);
+    }
+
+    /**
+     * @brief Returns ids and the I-th property collumns of the given vertexes, in the given order.
+     */
+    template<std::size_t ...I>
+    vertex_batch_t<I...> get_vertex_batch(const std::vector<vertex_t> &selection) const
+    {
+        std::vector<std::size_t> rows;
+        rows.reserve(selection.size());
+        for (auto &&v : selection)
+            rows.push_back(v.internal_id_);
+        return vertex_batch_t<I...>::gather(vertex_cols_, vertex_user_ids_, std::move(rows));
+    }
+
+    /**
+     * @brief Returns ids, endpoints and the I-th property collumns of all edges.
+     * @note Endpoints are internal vertex ids, i.e. rows of get_vertex_batch().
+     * @see get_vertex_batch
+     */
+    template<std::size_t ...I>
+    edge_batch_t<I...> get_edge_batch() const
+    {
+        auto batch = edge_batch_t<I...>::all(edge_cols_, edge_user_ids_);
+        batch.set_endpoints([this](std::size_t e) { return edges_[e].src_id_; }, [this](std::size_t e) { return edges_[e].dst_id_; });
+        return batch;
+    }
+
+    /**
+     * @brief Returns ids, endpoints and the I-th property collumns of the forward edges of the vertex.
+     */
+    template<std::size_t ...I>
+    edge_batch_t<I...> get_edge_batch(const vertex_t &v) const
+    {
+        std::vector<std::size_t> rows;
+        for_each_adjacent(v.internal_id_, [&rows](std::size_t e) { rows.push_back(e); });
+        auto batch = edge_batch_t<I...>::gather(edge_cols_, edge_user_ids_, std::move(rows));
+        batch.set_endpoints([this](std::size_t e) { return edges_[e].src_id_; }, [this](std::size_t e) { return edges_[e].dst_id_; });
+        return batch;
+    }
+
+    /**
+     * @brief Returns a snapshot of operation counters and memory held by the columns.
+     * @note Counters are collected only when compiled with GRAPH_DB_STATS, otherwise they are zero.
+     * @see db_stats
+     */
+    db_stats stats() const
+    {
+        db_stats s;
+        stats_.snapshot(s);
+
+        auto vertex_bytes = vertex_cols_.column_bytes();
+        for (std::size_t i = 0; i < vertex_bytes.size(); ++i)
+            s.vertex_columns[i].bytes = vertex_bytes[i];
+        auto edge_bytes = edge_cols_.column_bytes();
+        for (std::size_t i = 0; i < edge_bytes.size(); ++i)
+            s.edge_columns[i].bytes = edge_bytes[i];
+
+        s.adjacency_bytes = neighbours_.capacity() * sizeof(std::vector<std::size_t>) + adjacency_.bytes();
+        for (auto &&list : neighbours_)
+            s.adjacency_bytes += list.capacity() * sizeof(std::size_t);
+        return s;
+    }
+
+    /**
+     * @brief Returns the memory held by every property collumn, user id vector and the adjacency.
+     * @note Capacity slack and heap-owned bytes (e.g. of long strings) are reported separately.
+     * @see memory_report
+     */
+    memory_report memory_usage() const
+    {
+        memory_report r;
+        auto vertex_usage = vertex_cols_.memory_usage();
+        r.vertex_columns.assign(vertex_usage.begin(), vertex_usage.end());
+        auto edge_usage = edge_cols_.memory_usage();
+        r.edge_columns.assign(edge_usage.begin(), edge_usage.end());
+
+        r.vertex_user_ids = vector_usage(vertex_user_ids_);
+        r.edge_user_ids = vector_usage(edge_user_ids_);
+        r.vertices = vector_usage(vertices_);
+        r.edges = vector_usage(edges_);
+        r.neighbours = vector_usage(neighbours_);
+        r.neighbours.compressed_bytes = adjacency_.bytes();
+        return r;
+    }
+
+    /**
+     * @brief Freezes the adjacency lists into a delta + varint encoded byte array and releases the plain lists.
+     * @note neighbor_it_t decodes the compacted lists on the fly. Adding a vertex or an edge expands the lists again.
+     * With edge timestamps the lists are sorted by time first, unless sort_adjacency sorted them by destination.
+     */
+    void compact_adjacency()
+    {
+        if (compacted_)
+            return;
+        if constexpr (timestamp_t::enabled) {
+            for (std::size_t v = 0; v < neighbours_.size(); ++v) {
+                if (!adjacency_sorted_)
+                    sort_by_time(v);
+                if (time_sorted_[v] >= neighbours_[v].size())
+                    time_sorted_[v] = whole_list;
+            }
+        }
+        adjacency_.build(neighbours_);
+        std::vector<std::vector<std::size_t>>().swap(neighbours_);
+        compacted_ = true;
+    }
+
+    /**
+     * @brief Returns true if the adjacency lists are compacted.
+     * @see compact_adjacency
+     */
+    bool is_compacted() const
+    {
+        return compacted_;
+    }
+
+    /**
+     * @brief Sorts every adjacency list by the destination vertex (edges to the same vertex stay in insertion order).
+     * @note neighbor_it_t then iterates in destination order. Edges added later in destination order keep the lists sorted.
+     */
+    void sort_adjacency()
+    {
+        bool recompact = compacted_;
+        expand_adjacency();
+        for (auto &&list : neighbours_)
+            std::stable_sort(list.begin(), list.end(), [this](std::size_t a, std::size_t b) {
+                return edges_[a].dst_id_ < edges_[b].dst_id_;
+            });
+        adjacency_sorted_ = true;
+        if constexpr (timestamp_t::enabled)
+            std::fill(time_sorted_.begin(), time_sorted_.end(), 0);
+        if (recompact)
+            compact_adjacency();
+    }
+
+    /**
+     * @brief Returns true if every adjacency list is sorted by the destination vertex.
+     * @see sort_adjacency
+     */
+    bool is_adjacency_sorted() const
+    {
+        return adjacency_sorted_;
+    }
+
+    /**
+     * @brief Returns the number of leading edges of v which are known to be in time order.
+     * @note Needs a schema with edge_timestamp_index. Edges appended in time order keep the whole list sorted,
+     * otherwise the next edges_between query of v sorts the list.
+     */
+    std::size_t time_sorted_edges(const vertex_t &v) const
+    {
+        static_assert(timestamp_t::enabled, "The schema does not declare edge_timestamp_index");
+        std::size_t sorted = time_sorted_[v.internal_id_];
+        if (sorted != whole_list)
+            return sorted;
+        sorted = 0;
+        for_each_adjacent(v.internal_id_, [&sorted](std::size_t) { ++sorted; });
+        return sorted;
+    }
+
+    /**
+     * @brief Removes every edge whose timestamp is older than t.
+     * @return The number of removed edges.
+     * @note Needs a schema with edge_timestamp_index. Every list loses a prefix of its time-sorted order.
+     * Remaining edges get new internal ids, so edge handles and iterators obtained before are invalidated.
+     * Compressed edge collumns are decompressed. Enabled sketches are rebuilt, they cannot forget edges.
+     */
+    template<typename T>
+    std::size_t evict_edges_before(const T &t)
+    {
+        static_assert(timestamp_t::enabled, "The schema does not declare edge_timestamp_index");
+        bool recompact = compacted_;
+        expand_adjacency();
+
+        std::vector<char> keep(edges_.size(), 1);
+        std::size_t removed = 0;
+        for (std::size_t v = 0; v < neighbours_.size(); ++v) {
+            auto &list = neighbours_[v];
+            sort_by_time(v);
+            std::size_t cut = time_lower_bound(list, 0, list.size(), t);
+            for (std::size_t i = 0; i < cut; ++i)
+                keep[list[i]] = 0;
+            removed += cut;
+        }
+        if (!removed) {
+            if (recompact)
+                compact_adjacency();
+            return 0;
+        }
+
+        //old internal id -> new internal id, the insertion order of the remaining edges is kept
+        std::vector<std::size_t> remap(edges_.size());
+        std::vector<edge_t> edges;
+        std::vector<typename GraphSchema::edge_user_id_t> edge_user_ids;
+        edges.reserve(edges_.size() - removed);
+        edge_user_ids.reserve(edges_.size() - removed);
+        for (std::size_t e = 0; e < edges_.size(); ++e) {
+            if (!keep[e])
+                continue;
+            remap[e] = edges.size();
+            edges.emplace_back(edges.size(), edges_[e].src_id_, edges_[e].dst_id_, this);
+            edge_user_ids.push_back(std::move(edge_user_ids_[e]));
+        }
+        edges_.swap(edges);
+        edge_user_ids_.swap(edge_user_ids);
+        edge_cols_.keep_rows(keep);
+        for (std::size_t v = 0; v < neighbours_.size(); ++v) {
+            auto &list = neighbours_[v];
+            list.erase(std::remove_if(list.begin(), list.end(), [&keep](std::size_t e) { return !keep[e]; }), list.end());
+            for (auto &&e : list)
+                e = remap[e];
+            time_sorted_[v] = list.size();
+        }
+        if (recompact)
+            compact_adjacency();
+        if (sketches_)
+            enable_sketches();
+        return removed;
+    }
+
+    /**
+     * @brief Compresses the I-th vertex property collumn (frame-of-reference bit-packing or run-length encoding).
+     * @tparam I An index of the property, the property has to be of an integral type.
+     * @note read_property and scan_vertex_column read the compressed collumn in place. It is decompressed again
+     * by get_property (it returns a reference) and set_property of any of its rows, when a vertex is added
+     * or by decompress_vertex_column.
+     */
+    template<std::size_t I>
+    void compress_vertex_column()
+    {
+        vertex_cols_.template compress<I>();
+    }
+
+    /**
+     * @brief Compresses the I-th edge property collumn.
+     * @see compress_vertex_column
+     */
+    template<std::size_t I>
+    void compress_edge_column()
+    {
+        edge_cols_.template compress<I>();
+    }
+
+    /**
+     * @brief Decompresses the I-th vertex property collumn back into a plain vector.
+     * @note Does nothing when the collumn is not compressed.
+     */
+    template<std::size_t I>
+    void decompress_vertex_column()
+    {
+        vertex_cols_.template thaw<I>();
+    }
+
+    /**
+     * @brief Decompresses the I-th edge property collumn back into a plain vector.
+     * @see decompress_vertex_column
+     */
+    template<std::size_t I>
+    void decompress_edge_column()
+    {
+        edge_cols_.template thaw<I>();
+    }
+
+    /**
+     * @brief Reads the I-th vertex property collumn block by block.
+     * @param f Called as f(const T *values, std::size_t n, std::size_t first_row) for every block in insertion order.
+     * @note Compressed collumns are decompressed one block at a time.
+     */
+    template<std::size_t I, typename F>
+    void scan_vertex_column(F &&f) const
+    {
+        vertex_cols_.template scan<I>(std::forward<F>(f));
+    }
+
+    /**
+     * @brief Reads the I-th edge property collumn block by block.
+     * @see scan_vertex_column
+     */
+    template<std::size_t I, typename F>
+    void scan_edge_column(F &&f) const
+    {
+        edge_cols_.template scan<I>(std::forward<F>(f));
+    }
+
+    /**
+     * @brief Starts maintaining approximate statistics (distinct neighbours, in-degrees, out-degree quantiles) on every add_edge.
+     * @note The existing edges are added first. evict_edges_before rebuilds the sketches from the remaining edges.
+     * @see graph_sketches
+     */
+    void enable_sketches()
+    {
+        sketches_ = std::make_unique<graph_sketches>();
+        sketches_->resize(vertices_.size());
+        for (auto &&e : edges_)
+            sketches_->edge_added(e.src_id_, e.dst_id_);
+    }
+
+    void disable_sketches()
+    {
+        sketches_.reset();
+    }
+
+    /**
+     * @brief Returns the sketches keyed by internal vertex ids, nullptr unless enable_sketches was called.
+     */
+    const graph_sketches *sketches() const
+    {
+        return sketches_.get();
+    }
+
+    /**
+     * @brief Estimated number of distinct destinations of edges from v, zero without sketches.
+     */
+    double estimate_distinct_neighbours(const vertex_t &v) const
+    {
+        return sketches_ ? sketches_->distinct_neighbours(v.internal_id_) : 0.0;
+    }
+
+    /**
+     * @brief Estimated number of distinct vertices reachable from v by one or two edges, zero without sketches.
+     * @note Merges the sketches of the destinations of v, only the adjacency of v itself is read.
+     */
+    double estimate_two_hop(const vertex_t &v) const
+    {
+        if (!sketches_)
+            return 0.0;
+        std::vector<std::size_t> destinations;
+        for_each_adjacent(v.internal_id_, [this, &destinations](std::size_t e) { destinations.push_back(edges_[e].dst_id_); });
+        return sketches_->distinct_two_hop(v.internal_id_, destinations);
+    }
+
+    /**
+     * @brief Estimated in-degree of v (never smaller than the real one), zero without sketches.
+     */
+    std::uint64_t estimate_in_degree(const vertex_t &v) const
+    {
+        return sketches_ ? sketches_->in_degree(v.internal_id_) : 0;
+    }
+
+    /**
+     * @brief Vertices estimated to be destinations of at least fraction of all edges, the largest first.
+     */
+    std::vector<vertex_t> heavy_vertices(double fraction) const
+    {
+        std::vector<vertex_t> result;
+        if (sketches_)
+            for (auto &&h : sketches_->heavy_vertices(fraction))
+                result.push_back(vertices_[h.first]);
+        return result;
+    }
+
+    /**
+     * @brief q-quantile of out-degrees over all vertices, zero without sketches.
+     */
+    double degree_quantile(double q) const
+    {
+        return sketches_ ? sketches_->degree_quantile(q) : 0.0;
+    }
+
 private:
 
+    using stats_t = stats_collector<std::tuple_size<typename GraphSchema::vertex_property_t>::value,
+                                    std::tuple_size<typename GraphSchema::edge_property_t>::value>;
+
+    void expand_adjacency()
+    {
+        //turns compacted adjacency back into growable lists
+        if (!compacted_)
+            return;
+        adjacency_.unpack(neighbours_);
+        adjacency_.clear();
+        compacted_ = false;
+        if constexpr (timestamp_t::enabled) {
+            for (std::size_t v = 0; v < neighbours_.size(); ++v)
+                time_sorted_[v] = std::min(time_sorted_[v], neighbours_[v].size());
+        }
+    }
+
+    void keep_sorted(const edge_t &e)
+    {
+        //an edge appended out of destination order breaks sorted adjacency
+        const auto &list = neighbours_[e.src_id_];
+        if (adjacency_sorted_ && !list.empty() && edges_[list.back()].dst_id_ > e.dst_id_)
+            adjacency_sorted_ = false;
+    }
+
+    using timestamp_t = edge_timestamp<GraphSchema>;
+    static constexpr std::size_t whole_list = static_cast<std::size_t>(-1); //time_sorted_ of a time-sorted compacted list
+
+    auto timestamp(std::size_t e) const
+    {
+        constexpr std::size_t I = timestamp_t::index;
+        const auto *data = edge_cols_.template data<I>();
+        return data ? typename timestamp_t::type(data[e]) : edge_cols_.template at<I>(e);
+    }
+
+    void timestamp_changed(std::size_t e)
+    {
+        //keeps time_sorted_ the length of a time-sorted prefix: the prefix is cut before the edge if the edge
+        //breaks its order, and grows by the last edge of the list when that one is not older than the prefix
+        if constexpr (timestamp_t::enabled) {
+            std::size_t src = edges_[e].src_id_;
+            if (compacted_) {
+                time_sorted_[src] = 0;
+                return;
+            }
+            const auto &list = neighbours_[src];
+            std::size_t n = list.size();
+            std::size_t sorted = std::min(time_sorted_[src], n);
+            std::size_t pos = n && list.back() == e ? n - 1 : std::find(list.begin(), list.begin() + sorted, e) - list.begin();
+            if (pos < sorted && ((pos && timestamp(e) < timestamp(list[pos - 1])) || (pos + 1 < sorted && timestamp(list[pos + 1]) < timestamp(e))))
+                sorted = pos;
+            if (sorted + 1 == n && pos == n - 1 && (n == 1 || !(timestamp(e) < timestamp(list[n - 2]))))
+                sorted = n;
+            time_sorted_[src] = sorted;
+        }
+    }
+
+    template<std::size_t I>
+    void edge_property_changed(std::size_t e)
+    {
+        if constexpr (timestamp_t::enabled) {
+            if (I == timestamp_t::index)
+                timestamp_changed(e);
+        }
+    }
+
+    void sort_by_time(std::size_t v)
+    {
+        //lazily restores time order of the list, compacted adjacency is expanded first
+        if (compacted_ ? time_sorted_[v] == whole_list : time_sorted_[v] == neighbours_[v].size())
+            return;
+        expand_adjacency();
+        auto &list = neighbours_[v];
+        std::stable_sort(list.begin(), list.end(), [this](std::size_t a, std::size_t b) { return timestamp(a) < timestamp(b); });
+        time_sorted_[v] = list.size();
+        if (adjacency_sorted_)
+            adjacency_sorted_ = std::is_sorted(list.begin(), list.end(), [this](std::size_t a, std::size_t b) {
+                return edges_[a].dst_id_ < edges_[b].dst_id_;
+            });
+    }
+
+    template<typename T>
+    std::size_t time_lower_bound(const std::vector<std::size_t> &list, std::size_t first, std::size_t last, const T &t) const
+    {
+        //first position in [first, last) whose timestamp is not less than t
+        return std::partition_point(list.begin() + first, list.begin() + last, [this, &t](std::size_t e) { return timestamp(e) < t; }) - list.begin();
+    }
+
+    template<typename T>
+    std::pair<neighbor_it_t, neighbor_it_t> edges_between(std::size_t v, const T &t0, const T &t1)
+    {
+        static_assert(timestamp_t::enabled, "The schema does not declare edge_timestamp_index");
+        if (compacted_ && time_sorted_[v] == whole_list) {
+            //no random access into varints, the window is found by decoding the list
+            std::size_t pos = adjacency_.begin_of(v), end = adjacency_.end_of(v), e = 0, before = 0, begin = end, stop = end;
+            while (pos < end) {
+                std::size_t at = pos, prev = e;
+                e = compressed_adjacency::decode(adjacency_.data(), pos, e);
+                if (begin == end && !(timestamp(e) < t0)) {
+                    begin = at;
+                    before = prev;
+                }
+                if (t1 < timestamp(e)) {
+                    stop = at;
+                    break;
+                }
+            }
+            begin = std::min(begin, stop);
+            return std::make_pair(neighbor_it_t(adjacency_.data(), this, begin, stop, before), neighbor_it_t(adjacency_.data(), this, stop, stop));
+        }
+        if (compacted_) {
+            //a timestamp changed after compact_adjacency, only this list is decoded and sorted into a copy owned by the iterators
+            auto list = std::make_shared<std::vector<std::size_t>>();
+            for_each_adjacent(v, [&list](std::size_t e) { list->push_back(e); });
+            std::stable_sort(list->begin(), list->end(), [this](std::size_t a, std::size_t b) { return timestamp(a) < timestamp(b); });
+            std::size_t begin = time_lower_bound(*list, 0, list->size(), t0);
+            std::size_t stop = std::partition_point(list->begin() + begin, list->end(), [this, &t1](std::size_t e) { return !(t1 < timestamp(e)); }) - list->begin();
+            return std::make_pair(neighbor_it_t(list, this, begin), neighbor_it_t(list, this, stop));
+        }
+        sort_by_time(v);
+        const auto &list = neighbours_[v];
+        std::size_t begin = time_lower_bound(list, 0, list.size(), t0);
+        std::size_t stop = std::partition_point(list.begin() + begin, list.end(), [this, &t1](std::size_t e) { return !(t1 < timestamp(e)); }) - list.begin();
+        return std::make_pair(neighbor_it_t(&list, this, begin), neighbor_it_t(&list, this, stop));
+    }
+
+    template<typename F>
+    void for_each_adjacent(std::size_t v, F &&f) const
+    {
+        //calls f(edge internal id) for every edge from v, both for plain and compacted adjacency
+        if (!compacted_) {
+            for (auto e : neighbours_[v])
+                f(e);
+            return;
+        }
+        std::size_t pos = adjacency_.begin_of(v), end = adjacency_.end_of(v), e = 0;
+        while (pos < end) {
+            e = compressed_adjacency::decode(adjacency_.data(), pos, e);
+            f(e);
+        }
+    }
+
+    static std::size_t internal_id(const vertex_t &v) { return v.internal_id_; }
+    static std::size_t internal_id(const edge_t &e) { return e.internal_id_; }
+    std::size_t edge_src(std::size_t e) const { return edges_[e].src_id_; }
+    std::size_t edge_dst(std::size_t e) const { return edges_[e].dst_id_; }
+
+    static void count_deref(const vertex_t &v) { v.db_->stats_.vertex_deref(); }
+    static void count_deref(const edge_t &e) { e.db_->stats_.edge_deref(); }
+
     friend class vertex<GraphSchema>;
     friend class edge<GraphSchema>;
     friend class neighbour_iterator<edge<GraphSchema>, GraphSchema>;
     friend class my_iterator<GraphSchema, vertex_t>;
     friend class my_iterator<GraphSchema, edge_t>;
+    friend class neighbour_index<GraphSchema>;
+    friend class subgraph_view<GraphSchema>;
+    friend class snapshot<GraphSchema>;
+    template <class, typename, typename> friend class pregel;
+    template <class, std::size_t ...> friend class inline_adjacency;
+    friend class partitioner<GraphSchema>;
+    friend class sharded_graph<GraphSchema>;
 
     std::vector<edge_t> edges_; //vector of all edges -> indexes are internal ids
     std::vector<vertex_t> vertices_; //vector of all verticies -> indexes are internal ids
 
     std::vector<std::vector<std::size_t>> neighbours_; //2D vector of edges going from the same source
+    compressed_adjacency adjacency_; //neighbours_ encoded by compact_adjacency()
+    bool compacted_ = false; //true if adjacency_ is used instead of neighbours_
+    bool adjacency_sorted_ = false; //true if every list is sorted by destination vertex
+    std::vector<std::size_t> time_sorted_; //length of the time-sorted prefix of every list, used only with edge timestamps
 
     std::vector<typename GraphSchema::vertex_user_id_t> vertex_user_ids_; //vector of user ids for vertexes -> indexes are internal ids
     std::vector<typename GraphSchema::edge_user_id_t> edge_user_ids_; //vector of user ids for edges -> indexes are internal ids
 
-    columns<GraphSchema, typename GraphSchema::vertex_property_t> vertex_cols_; //collumnar database for properties of verties
-    columns<GraphSchema, typename GraphSchema::edge_property_t> edge_cols_; //collumnar database for properties of edges
+    columns<GraphSchema, typename GraphSchema::vertex_property_t, typename vertex_layout<GraphSchema>::type> vertex_cols_; //collumnar database for properties of verties
+    columns<GraphSchema, typename GraphSchema::edge_property_t, typename edge_layout<GraphSchema>::type> edge_cols_; //collumnar database for properties of edges
+
+    stats_t stats_; //operation counters, empty unless GRAPH_DB_STATS is defined
+    std::unique_ptr<graph_sketches> sketches_; //approximate statistics, null unless enable_sketches() was called
 
 };
 
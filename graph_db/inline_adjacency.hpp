@@ -0,0 +1,89 @@
+#ifndef INLINE_ADJACENCY_HPP
+#define INLINE_ADJACENCY_HPP
+
+#include "graph_db.hpp"
+
+#include <vector>
+#include <tuple>
+#include <utility>
+
+template <class GraphSchema>
+class graph_db;
+template <class GraphSchema, std::size_t ...I>
+class inline_adjacency;
+
+/**
+ * @brief A frozen adjacency layout with destination ids and chosen hot edge properties stored inline in every neighbour entry.
+ * @tparam GraphSchema The schema of the database.
+ * @tparam I Indexes of the edge properties copied into the entries.
+ * @note Traversals read one contiguous array instead of going through edges_ and the edge property collumns.
+ * The layout is a snapshot, later changes of the database are not reflected.
+ */
+template <class GraphSchema, std::size_t ...I>
+class inline_adjacency {
+public:
+    using db_t = graph_db<GraphSchema>;
+    using vertex_t = typename db_t::vertex_t;
+    using edge_t = typename db_t::edge_t;
+    using props_t = std::tuple<std::tuple_element_t<I, typename GraphSchema::edge_property_t>...>;
+
+    /**
+     * @brief One neighbour of a vertex.
+     */
+    struct entry {
+        std::size_t dst; //internal id of the destination vertex
+        std::size_t edge; //internal id of the edge
+        props_t props; //copies of the selected edge properties
+
+        /**
+         * @brief Returns the K-th selected property (K indexes the I... list, not the edge schema).
+         */
+        template <std::size_t K>
+        const auto &get() const { return std::get<K>(props); }
+    };
+
+    explicit inline_adjacency(const db_t &db) : db_(&db) {
+        std::size_t n = db.vertices_.size();
+        offsets_.reserve(n + 1);
+        offsets_.push_back(0);
+        std::size_t edges = 0;
+        for (auto &&list : db.neighbours_)
+            edges += list.size();
+        entries_.reserve(db.compacted_ ? db.edges_.size() : edges);
+        for (std::size_t v = 0; v < n; ++v) {
+            db.for_each_adjacent(v, [this, &db](std::size_t e) {
+                edge_t edge = db.edges_[e];
+                entries_.push_back(entry{ db.edge_dst(e), e, props_t(edge.template read_property<I>()...) });
+            });
+            offsets_.push_back(entries_.size());
+        }
+    }
+
+    /**
+     * @brief Returns begin and end of the neighbour entries of the vertex.
+     */
+    std::pair<const entry *, const entry *> neighbours(const vertex_t &v) const {
+        std::size_t id = db_t::internal_id(v);
+        return std::make_pair(entries_.data() + offsets_[id], entries_.data() + offsets_[id + 1]);
+    }
+
+    /**
+     * @brief Returns begin and end of the neighbour entries of the vertex with the given internal id.
+     */
+    std::pair<const entry *, const entry *> neighbours(std::size_t id) const {
+        return std::make_pair(entries_.data() + offsets_[id], entries_.data() + offsets_[id + 1]);
+    }
+
+    vertex_t dst(const entry &e) const { return db_->vertices_[e.dst]; }
+    edge_t edge(const entry &e) const { return db_->edges_[e.edge]; }
+
+    std::size_t vertex_count() const { return offsets_.size() - 1; }
+    std::size_t bytes() const { return offsets_.capacity() * sizeof(std::size_t) + entries_.capacity() * sizeof(entry); }
+
+private:
+    const db_t *db_;
+    std::vector<std::size_t> offsets_; //entries of v-th vertex are entries_[offsets_[v] .. offsets_[v+1])
+    std::vector<entry> entries_;
+};
+
+#endif //INLINE_ADJACENCY_HPP
@@ -0,0 +1,189 @@
+#ifndef INTERSECTIONS_HPP
+#define INTERSECTIONS_HPP
+
+#include "graph_db.hpp"
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+
+template <class GraphSchema>
+class graph_db;
+
+/**
+ * @brief Size of the intersection of two sorted arrays of unique ids by a branch-free merge.
+ */
+inline std::size_t intersect_merge(const std::size_t *a, std::size_t na, const std::size_t *b, std::size_t nb) noexcept {
+    std::size_t i = 0, j = 0, count = 0;
+    while (i < na && j < nb) {
+        std::size_t x = a[i], y = b[j];
+        count += x == y;
+        i += x <= y;
+        j += y <= x;
+    }
+    return count;
+}
+
+/**
+ * @brief Size of the intersection of a short sorted array a with a much longer sorted array b by galloping search.
+ */
+inline std::size_t intersect_gallop(const std::size_t *a, std::size_t na, const std::size_t *b, std::size_t nb) noexcept {
+    std::size_t count = 0, lo = 0;
+    for (std::size_t i = 0; i < na && lo < nb; ++i) {
+        //exponential search for the first b[k] >= a[i], then binary search inside the found range
+        std::size_t step = 1, hi = lo;
+        while (hi < nb && b[hi] < a[i]) {
+            lo = hi + 1;
+            hi += step;
+            step <<= 1;
+        }
+        lo = std::lower_bound(b + lo, b + std::min(hi + 1, nb), a[i]) - b;
+        if (lo < nb && b[lo] == a[i])
+            ++count;
+    }
+    return count;
+}
+
+/**
+ * @brief Size of the intersection of two sorted arrays of unique ids, picks merge or galloping by their lengths.
+ */
+inline std::size_t intersection_size(const std::size_t *a, std::size_t na, const std::size_t *b, std::size_t nb) noexcept {
+    if (na > nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (na * 16 < nb)
+        return intersect_gallop(a, na, b, nb);
+    return intersect_merge(a, na, b, nb);
+}
+
+/**
+ * @brief Sorted and deduplicated neighbour vertex ids of every vertex in a compressed sparse row layout.
+ * @tparam GraphSchema The schema of the indexed database.
+ * @note The index is a snapshot, it does not see vertices and edges added later.
+ */
+template <class GraphSchema>
+class neighbour_index {
+public:
+    using vertex_t = typename graph_db<GraphSchema>::vertex_t;
+
+    /**
+     * @brief Builds the index.
+     * @param db The indexed database.
+     * @param undirected If true, every edge is added in both directions and self loops are dropped.
+     */
+    explicit neighbour_index(const graph_db<GraphSchema> &db, bool undirected = true) {
+        std::size_t n = db.vertices_.size();
+        std::vector<std::vector<std::size_t>> lists(n);
+        for (std::size_t v = 0; v < n; ++v) {
+            db.for_each_adjacent(v, [&](std::size_t e) {
+                std::size_t dst = db.edge_dst(e);
+                if (!undirected) {
+                    lists[v].push_back(dst);
+                } else if (dst != v) {
+                    lists[v].push_back(dst);
+                    lists[dst].push_back(v);
+                }
+            });
+        }
+
+        offsets_.reserve(n + 1);
+        offsets_.push_back(0);
+        for (auto &&list : lists) {
+            if (!db.adjacency_sorted_ || undirected)
+                std::sort(list.begin(), list.end());
+            list.erase(std::unique(list.begin(), list.end()), list.end());
+            ids_.insert(ids_.end(), list.begin(), list.end());
+            offsets_.push_back(ids_.size());
+            std::vector<std::size_t>().swap(list);
+        }
+    }
+
+    std::size_t vertex_count() const noexcept { return offsets_.size() - 1; }
+    std::size_t degree(std::size_t v) const noexcept { return offsets_[v + 1] - offsets_[v]; }
+    const std::size_t *begin(std::size_t v) const noexcept { return ids_.data() + offsets_[v]; }
+    const std::size_t *end(std::size_t v) const noexcept { return ids_.data() + offsets_[v + 1]; }
+
+    /**
+     * @brief Returns the number of common neighbours of the two vertices.
+     */
+    std::size_t common_neighbours(const vertex_t &a, const vertex_t &b) const noexcept {
+        return common(graph_db<GraphSchema>::internal_id(a), graph_db<GraphSchema>::internal_id(b));
+    }
+
+    /**
+     * @brief Returns the Jaccard similarity |N(a) & N(b)| / |N(a) | N(b)| of the two vertices.
+     */
+    double jaccard(const vertex_t &a, const vertex_t &b) const noexcept {
+        std::size_t u = graph_db<GraphSchema>::internal_id(a), v = graph_db<GraphSchema>::internal_id(b);
+        std::size_t both = common(u, v);
+        std::size_t any = degree(u) + degree(v) - both;
+        return any ? static_cast<double>(both) / any : 0.0;
+    }
+
+    /**
+     * @brief Counts triangles of the undirected graph in parallel.
+     * @param thrs Number of threads.
+     * @note Every triangle is counted once. Requires an index built with undirected = true.
+     */
+    std::uint64_t count_triangles(std::size_t thrs = std::thread::hardware_concurrency()) const {
+        //orient every edge from lower to higher (degree, id) rank and intersect out-neighbourhoods
+        std::size_t n = vertex_count();
+        std::vector<std::size_t> out_offsets(n + 1, 0), out_ids;
+        out_ids.reserve(ids_.size() / 2);
+        for (std::size_t v = 0; v < n; ++v) {
+            for (auto u = begin(v); u != end(v); ++u)
+                if (ranks_before(v, *u))
+                    out_ids.push_back(*u);
+            out_offsets[v + 1] = out_ids.size();
+        }
+
+        if (thrs == 0)
+            thrs = 1;
+        std::atomic<std::size_t> next{0};
+        std::vector<std::uint64_t> partial(thrs, 0);
+        auto worker = [&](std::size_t id) {
+            const std::size_t chunk = 256;
+            std::uint64_t count = 0;
+            for (std::size_t first = next.fetch_add(chunk); first < n; first = next.fetch_add(chunk)) {
+                for (std::size_t v = first; v < std::min(first + chunk, n); ++v) {
+                    const std::size_t *vb = out_ids.data() + out_offsets[v];
+                    std::size_t vn = out_offsets[v + 1] - out_offsets[v];
+                    for (std::size_t k = 0; k < vn; ++k) {
+                        std::size_t u = vb[k];
+                        count += intersection_size(vb, vn, out_ids.data() + out_offsets[u], out_offsets[u + 1] - out_offsets[u]);
+                    }
+                }
+            }
+            partial[id] = count;
+        };
+
+        std::vector<std::thread> threads;
+        for (std::size_t i = 1; i < thrs; ++i)
+            threads.emplace_back(worker, i);
+        worker(0);
+        for (auto &&t : threads)
+            t.join();
+
+        std::uint64_t total = 0;
+        for (auto p : partial)
+            total += p;
+        return total;
+    }
+
+private:
+    std::size_t common(std::size_t u, std::size_t v) const noexcept {
+        return intersection_size(begin(u), degree(u), begin(v), degree(v));
+    }
+
+    bool ranks_before(std::size_t v, std::size_t u) const noexcept {
+        return degree(v) < degree(u) || (degree(v) == degree(u) && v < u);
+    }
+
+    std::vector<std::size_t> offsets_; //ids of v-th vertex are ids_[offsets_[v] .. offsets_[v+1])
+    std::vector<std::size_t> ids_;
+};
+
+#endif //INTERSECTIONS_HPP
@@ -2,8 +2,13 @@
 #define ITERATORS_HPP
 
 #include "graph_db.hpp"
+#include "adjacency.hpp"
 
 #include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <memory>
 
 template <class GraphSchema>
 class graph_db;
@@ -12,28 +17,36 @@ template <class GraphSchema, typename T>
 class my_iterator{ //iteartor used for vertex/edge iterating
 
 public:
+    //dereferencing returns a handle by value, so the iterator is an input iterator for the standard library
+    using iterator_category = std::input_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = T;
+
     my_iterator(const std::vector<T>* vec, std::size_t index): vec_(vec), index_(index) {}; 
 
-    my_iterator operator++() {
-        my_iterator it = *this;
+    my_iterator& operator++() {
         ++index_;
-        return it;
+        return *this;
     }
     my_iterator operator++(int) {
+        my_iterator it = *this;
         ++index_;
-        return *this;
+        return it;
     }
 
-    T operator*() { //tady mozna pretypovani na T???
+    T operator*() const { //tady mozna pretypovani na T???
+        graph_db<GraphSchema>::count_deref((*vec_)[index_]);
         return T((*vec_)[index_]);
     }
 
-    bool operator!=(const my_iterator& it2) {
+    bool operator!=(const my_iterator& it2) const {
         return index_ != it2.index_;
     }
     
-    bool operator==(const my_iterator& it2) {
-        return !(this != it2);
+    bool operator==(const my_iterator& it2) const {
+        return !(*this != it2);
     }
 
 private:
@@ -46,43 +59,78 @@ template <typename Ret, class GraphSchema>
 class neighbour_iterator{ //iterator used for iterating over neighbours of specified vertex
 
 public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Ret;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = Ret;
+
     neighbour_iterator(const std::vector< std::size_t>* ptr, graph_db<GraphSchema>* db, std::size_t index): ptr_(ptr), index_(index), db_(db) {};
 
-    neighbour_iterator operator++ ()
+    //iterator over a list built for the query (e.g. a sorted copy of a compacted list), the iterators share its ownership
+    neighbour_iterator(std::shared_ptr<const std::vector<std::size_t>> list, graph_db<GraphSchema>* db, std::size_t index): ptr_(list.get()), index_(index), db_(db), list_(std::move(list)) {};
+
+    //iterator over compacted adjacency, index_ is a byte position of the current edge id
+    //prev is the id decoded before pos, the deltas of a list start from 0 at its head
+    neighbour_iterator(const std::uint8_t* bytes, graph_db<GraphSchema>* db, std::size_t pos, std::size_t end, std::size_t prev = 0): ptr_(nullptr), index_(pos), db_(db), bytes_(bytes), next_(pos), end_(end) {
+        if (next_ < end_)
+            current_ = compressed_adjacency::decode(bytes_, next_, prev);
+    };
+
+    neighbour_iterator& operator++ ()
     {
-        neighbour_iterator it = *this;
-        ++index_;
-        return it;
+        step();
+        return *this;
     }
 
     neighbour_iterator operator++ (int)
     {
-        ++index_;
-
-        return *this;
+        neighbour_iterator it = *this;
+        step();
+        return it;
     }
 
-    Ret operator*() {
-        
-        return Ret((db_)->edges_[(*ptr_)[index_]]);
+    Ret operator*() const {
+        db_->stats_.neighbour_deref();
+        return Ret((db_)->edges_[edge_id()]);
     }
 
-    bool operator!=(const neighbour_iterator& it2) {
-        return this->ptr_ != it2.ptr_ || this->index_ != it2.index_;
+    bool operator!=(const neighbour_iterator& it2) const {
+        return this->ptr_ != it2.ptr_ || this->bytes_ != it2.bytes_ || this->index_ != it2.index_;
     }
     
-    bool operator==(const neighbour_iterator& it2) {
-        return !(this != it2);
+    bool operator==(const neighbour_iterator& it2) const {
+        return !(*this != it2);
     }
 
 private:
 
     friend class graph_db<GraphSchema>;
 
+    std::size_t edge_id() const {
+        return bytes_ ? current_ : (*ptr_)[index_];
+    }
+
+    void step() {
+        if (!bytes_) {
+            ++index_;
+            return;
+        }
+        //decode the following delta on the fly
+        index_ = next_;
+        if (next_ < end_)
+            current_ = compressed_adjacency::decode(bytes_, next_, current_);
+    }
+
     const std::vector<std::size_t>* ptr_;
     std::size_t index_;
     const graph_db<GraphSchema>* db_;
 
+    const std::uint8_t* bytes_ = nullptr; //compacted adjacency, nullptr when iterating neighbours_
+    std::size_t next_ = 0, end_ = 0; //byte position of the following edge id and end of the list
+    std::size_t current_ = 0; //decoded id of the current edge
+    std::shared_ptr<const std::vector<std::size_t>> list_; //keeps a list built for the query alive, null otherwise
+
 };
 
 
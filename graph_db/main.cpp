@@ -4,6 +4,13 @@
 #include <string>
 
 #include "graph_db.hpp"
+#include "intersections.hpp"
+#include "subgraph_view.hpp"
+#include "snapshot.hpp"
+#include "pregel.hpp"
+#include "inline_adjacency.hpp"
+#include "partition.hpp"
+#include "aggregate.hpp"
 #include "tests.hpp"
 
 
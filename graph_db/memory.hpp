@@ -0,0 +1,104 @@
+#ifndef MEMORY_HPP
+#define MEMORY_HPP
+
+#include <vector>
+#include <string>
+#include <tuple>
+#include <cstdint>
+
+/**
+ * @brief Memory held by a single container of the database.
+ */
+struct memory_entry {
+    std::size_t used_bytes = 0; //size() * sizeof(element)
+    std::size_t capacity_bytes = 0; //capacity() * sizeof(element)
+    std::size_t heap_bytes = 0; //bytes owned by the elements themselves (e.g. long strings, inner vectors)
+    std::size_t compressed_bytes = 0; //bytes of the cold (compressed) copy of the column
+
+    std::size_t slack() const { return capacity_bytes - used_bytes; }
+    std::size_t total() const { return capacity_bytes + heap_bytes + compressed_bytes; }
+
+    memory_entry &operator+=(const memory_entry &o) {
+        used_bytes += o.used_bytes;
+        capacity_bytes += o.capacity_bytes;
+        heap_bytes += o.heap_bytes;
+        compressed_bytes += o.compressed_bytes;
+        return *this;
+    }
+};
+
+/**
+ * @brief A breakdown of the memory held by a graph database returned by graph_db::memory_usage().
+ */
+struct memory_report {
+    std::vector<memory_entry> vertex_columns;
+    std::vector<memory_entry> edge_columns;
+    memory_entry vertex_user_ids;
+    memory_entry edge_user_ids;
+    memory_entry vertices;
+    memory_entry edges;
+    memory_entry neighbours;
+
+    std::size_t total() const {
+        std::size_t sum = vertex_user_ids.total() + edge_user_ids.total() + vertices.total() + edges.total() + neighbours.total();
+        for (auto &&c : vertex_columns)
+            sum += c.total();
+        for (auto &&c : edge_columns)
+            sum += c.total();
+        return sum;
+    }
+};
+
+//bytes allocated on the heap by a single value
+template <typename T>
+std::size_t heap_bytes(const T &) noexcept { return 0; }
+
+template <typename C, typename Tr, typename A>
+std::size_t heap_bytes(const std::basic_string<C, Tr, A> &s) noexcept {
+    //short strings live inside the object itself
+    auto data = reinterpret_cast<const char *>(s.data());
+    auto self = reinterpret_cast<const char *>(&s);
+    if (data >= self && data < self + sizeof(s))
+        return 0;
+    return (s.capacity() + 1) * sizeof(C);
+}
+
+template <typename ...Ts>
+std::size_t heap_bytes(const std::tuple<Ts...> &t) noexcept {
+    //rows of grouped (array of structs) collumns
+    return std::apply([](const auto &...items) { return (std::size_t(0) + ... + heap_bytes(items)); }, t);
+}
+
+template <typename T, typename A>
+std::size_t heap_bytes(const std::vector<T, A> &v) noexcept {
+    std::size_t sum = v.capacity() * sizeof(T);
+    for (auto &&item : v)
+        sum += heap_bytes(item);
+    return sum;
+}
+
+template <typename A>
+std::size_t heap_bytes(const std::vector<bool, A> &v) noexcept {
+    return (v.capacity() + 7) / 8;
+}
+
+template <typename T, typename A>
+memory_entry vector_usage(const std::vector<T, A> &v) noexcept {
+    memory_entry e;
+    e.used_bytes = v.size() * sizeof(T);
+    e.capacity_bytes = v.capacity() * sizeof(T);
+    for (auto &&item : v)
+        e.heap_bytes += heap_bytes(item);
+    return e;
+}
+
+template <typename A>
+memory_entry vector_usage(const std::vector<bool, A> &v) noexcept {
+    //bits are packed into words
+    memory_entry e;
+    e.used_bytes = (v.size() + 7) / 8;
+    e.capacity_bytes = (v.capacity() + 7) / 8;
+    return e;
+}
+
+#endif //MEMORY_HPP
@@ -0,0 +1,215 @@
+#ifndef PACKED_COLUMN_HPP
+#define PACKED_COLUMN_HPP
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <type_traits>
+#include <cstdint>
+
+/**
+ * @brief A compressed, read-only copy of a cold property column.
+ * @tparam T The type of the property.
+ * @note Only integral types (including bool and char) can be compressed, other types get this empty placeholder.
+ */
+template <typename T, typename Enable = void>
+class packed_column {
+public:
+    static constexpr bool supported = false;
+
+    bool empty() const noexcept { return true; }
+    std::size_t bytes() const noexcept { return 0; }
+    void clear() noexcept {}
+};
+
+/**
+ * @brief Integral column compressed by frame-of-reference + bit-packing in blocks of block_size rows.
+ * One byte types (bool, char) may use run-length encoding instead, whichever of the two is smaller.
+ */
+template <typename T>
+class packed_column<T, std::enable_if_t<std::is_integral<T>::value>> {
+public:
+    static constexpr bool supported = true;
+    static constexpr std::size_t block_size = 256;
+
+    /**
+     * @brief Compresses the given column, replacing any previous content.
+     */
+    template <typename Vec>
+    void pack(const Vec &column) {
+        clear();
+        size_ = column.size();
+        pack_bits(column);
+        if (sizeof(T) == 1) {
+            packed_column runs;
+            runs.size_ = size_;
+            runs.pack_runs(column);
+            if (runs.bytes() < bytes())
+                *this = std::move(runs);
+        }
+    }
+
+    /**
+     * @brief Decompresses the whole column into out.
+     */
+    template <typename Vec>
+    void unpack(Vec &out) const {
+        out.clear();
+        out.reserve(size_);
+        for_each_block([&out](const T *values, std::size_t n, std::size_t) {
+            out.insert(out.end(), values, values + n);
+        });
+    }
+
+    /**
+     * @brief Decompresses the column block by block and calls f(const T *values, std::size_t n, std::size_t first_row) for every block.
+     */
+    template <typename F>
+    void for_each_block(F &&f) const {
+        std::array<T, block_size> buffer;
+        if (runs_encoded_) {
+            //runs are emitted in chunks of at most block_size rows
+            std::size_t row = 0, filled = 0;
+            for (std::size_t r = 0; r < run_values_.size(); ++r) {
+                for (; row < run_ends_[r]; ++row) {
+                    buffer[filled++] = run_values_[r];
+                    if (filled == block_size) {
+                        f(buffer.data(), filled, row + 1 - filled);
+                        filled = 0;
+                    }
+                }
+            }
+            if (filled)
+                f(buffer.data(), filled, row - filled);
+            return;
+        }
+        for (std::size_t block = 0; block < bases_.size(); ++block) {
+            std::size_t first = block * block_size;
+            std::size_t n = std::min(block_size, size_ - first);
+            for (std::size_t i = 0; i < n; ++i)
+                buffer[i] = decode(block, i);
+            f(buffer.data(), n, first);
+        }
+    }
+
+    /**
+     * @brief Random access to a single row.
+     */
+    T at(std::size_t row) const {
+        if (runs_encoded_) {
+            auto run = std::upper_bound(run_ends_.begin(), run_ends_.end(), row) - run_ends_.begin();
+            return run_values_[run];
+        }
+        return decode(row / block_size, row % block_size);
+    }
+
+    std::size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    bool runs_encoded() const noexcept { return runs_encoded_; }
+
+    std::size_t bytes() const noexcept {
+        return words_.capacity() * sizeof(std::uint64_t) + bases_.capacity() * sizeof(T)
+            + widths_.capacity() + offsets_.capacity() * sizeof(std::size_t)
+            + run_values_.capacity() * sizeof(T) + run_ends_.capacity() * sizeof(std::size_t);
+    }
+
+    void clear() noexcept {
+        *this = packed_column();
+    }
+
+private:
+    using word_t = std::uint64_t;
+
+    template <typename Vec>
+    void pack_bits(const Vec &column) {
+        std::size_t blocks = (size_ + block_size - 1) / block_size;
+        bases_.reserve(blocks);
+        widths_.reserve(blocks);
+        offsets_.reserve(blocks);
+        for (std::size_t first = 0; first < size_; first += block_size) {
+            std::size_t n = std::min(block_size, size_ - first);
+            T lo = column[first], hi = column[first];
+            for (std::size_t i = 1; i < n; ++i) {
+                lo = std::min<T>(lo, column[first + i]);
+                hi = std::max<T>(hi, column[first + i]);
+            }
+            word_t base = to_word(lo);
+            std::uint8_t width = bit_width(to_word(hi) - base);
+
+            bases_.push_back(lo);
+            widths_.push_back(width);
+            offsets_.push_back(words_.size());
+            words_.resize(words_.size() + (n * width + 63) / 64);
+
+            word_t *out = words_.data() + offsets_.back();
+            for (std::size_t i = 0; i < n && width; ++i) {
+                word_t delta = to_word(column[first + i]) - base;
+                std::size_t bit = i * width;
+                out[bit / 64] |= delta << (bit % 64);
+                if (bit % 64 + width > 64)
+                    out[bit / 64 + 1] |= delta >> (64 - bit % 64);
+            }
+        }
+        words_.shrink_to_fit();
+    }
+
+    template <typename Vec>
+    void pack_runs(const Vec &column) {
+        runs_encoded_ = true;
+        for (std::size_t row = 0; row < size_; ++row) {
+            T value = column[row];
+            if (run_values_.empty() || run_values_.back() != value) {
+                run_values_.push_back(value);
+                run_ends_.push_back(row + 1);
+            } else {
+                run_ends_.back() = row + 1;
+            }
+        }
+        run_values_.shrink_to_fit();
+        run_ends_.shrink_to_fit();
+    }
+
+    T decode(std::size_t block, std::size_t i) const {
+        std::uint8_t width = widths_[block];
+        if (!width)
+            return bases_[block];
+        const word_t *in = words_.data() + offsets_[block];
+        std::size_t bit = i * width;
+        word_t delta = in[bit / 64] >> (bit % 64);
+        if (bit % 64 + width > 64)
+            delta |= in[bit / 64 + 1] << (64 - bit % 64);
+        if (width < 64)
+            delta &= (word_t(1) << width) - 1;
+        return from_word(to_word(bases_[block]) + delta);
+    }
+
+    static word_t to_word(T v) noexcept {
+        //keeps the order of signed values so that the difference hi - lo is the unsigned range
+        return static_cast<word_t>(static_cast<std::conditional_t<std::is_signed<T>::value, std::int64_t, std::uint64_t>>(v));
+    }
+    static T from_word(word_t w) noexcept { return static_cast<T>(w); }
+
+    static std::uint8_t bit_width(word_t range) noexcept {
+        std::uint8_t width = 0;
+        while (range) {
+            ++width;
+            range >>= 1;
+        }
+        return width;
+    }
+
+    std::size_t size_ = 0;
+    bool runs_encoded_ = false;
+
+    //frame-of-reference encoding, one entry per block
+    std::vector<T> bases_;
+    std::vector<std::uint8_t> widths_;
+    std::vector<std::size_t> offsets_; //first word of the block in words_
+    std::vector<word_t> words_;
+
+    //run-length encoding, run r covers rows [run_ends_[r-1], run_ends_[r])
+    std::vector<T> run_values_;
+    std::vector<std::size_t> run_ends_;
+};
+
+#endif //PACKED_COLUMN_HPP
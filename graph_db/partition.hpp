@@ -0,0 +1,561 @@
+#ifndef PARTITION_HPP
+#define PARTITION_HPP
+
+#include "graph_db.hpp"
+#include "pregel.hpp"
+
+#include <vector>
+#include <memory>
+#include <tuple>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <cstdint>
+#include <new>
+#include <thread>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+template <class GraphSchema>
+class graph_db;
+template <class GraphSchema>
+class partitioner;
+template <class GraphSchema>
+class sharded_graph;
+
+/**
+ * @brief Edge cut and balance of a partitioning.
+ */
+struct partition_quality {
+    std::size_t cut_edges = 0; //edges whose endpoints are in different shards
+    std::size_t total_edges = 0;
+    std::size_t largest = 0; //vertices in the largest shard
+    double balance = 0; //largest shard / average shard, 1 is perfect
+};
+
+/**
+ * @brief Computes assignments of vertices to shards, the result is indexed by internal vertex ids.
+ * @tparam GraphSchema The schema of the database.
+ */
+template <class GraphSchema>
+class partitioner {
+public:
+    using db_t = graph_db<GraphSchema>;
+
+    /**
+     * @brief Assigns every vertex to the shard given by the hash of its user id.
+     */
+    static std::vector<std::size_t> hash(const db_t &db, std::size_t k) {
+        std::vector<std::size_t> part(db.vertices_.size());
+        std::hash<typename GraphSchema::vertex_user_id_t> h;
+        for (std::size_t v = 0; v < part.size(); ++v)
+            part[v] = mix(h(db.vertex_user_ids_[v])) % k;
+        return part;
+    }
+
+    /**
+     * @brief Streaming linear deterministic greedy partitioning.
+     * @param slack Every shard holds at most slack * vertices / k vertices.
+     * @note Vertices are streamed in insertion order, each goes to the shard holding most of its already placed neighbours
+     * (edges in both directions), weighted by the free capacity of the shard.
+     */
+    static std::vector<std::size_t> ldg(const db_t &db, std::size_t k, double slack = 1.05) {
+        std::size_t n = db.vertices_.size();
+        std::vector<std::size_t> part(n, k);
+        if (!n)
+            return part;
+
+        //reverse adjacency, so that already placed sources of in-edges are counted too
+        std::vector<std::size_t> in_offsets(n + 1, 0), in_sources(db.edges_.size());
+        for (std::size_t e = 0; e < db.edges_.size(); ++e)
+            ++in_offsets[db.edge_dst(e) + 1];
+        for (std::size_t v = 0; v < n; ++v)
+            in_offsets[v + 1] += in_offsets[v];
+        std::vector<std::size_t> fill(in_offsets.begin(), in_offsets.end() - 1);
+        for (std::size_t e = 0; e < db.edges_.size(); ++e)
+            in_sources[fill[db.edge_dst(e)]++] = db.edge_src(e);
+
+        double capacity = std::max(1.0, slack * n / k);
+        std::vector<std::size_t> sizes(k, 0), counts(k, 0), touched;
+        auto count = [&](std::size_t u) {
+            std::size_t p = part[u];
+            if (p == k)
+                return;
+            if (!counts[p]++)
+                touched.push_back(p);
+        };
+        for (std::size_t v = 0; v < n; ++v) {
+            db.for_each_adjacent(v, [&](std::size_t e) { count(db.edge_dst(e)); });
+            for (std::size_t i = in_offsets[v]; i < in_offsets[v + 1]; ++i)
+                count(in_sources[i]);
+
+            //the smallest shard wins ties, so vertices without placed neighbours spread evenly
+            std::size_t best = std::min_element(sizes.begin(), sizes.end()) - sizes.begin();
+            double best_score = 0;
+            for (auto p : touched) {
+                if (sizes[p] + 1 > capacity)
+                    continue;
+                double score = counts[p] * (1.0 - sizes[p] / capacity);
+                if (score > best_score || (score == best_score && sizes[p] < sizes[best])) {
+                    best = p;
+                    best_score = score;
+                }
+            }
+            for (auto p : touched)
+                counts[p] = 0;
+            touched.clear();
+            part[v] = best;
+            ++sizes[best];
+        }
+        return part;
+    }
+
+    static partition_quality quality(const db_t &db, const std::vector<std::size_t> &part, std::size_t k) {
+        partition_quality q;
+        std::vector<std::size_t> sizes(k, 0);
+        for (auto p : part)
+            ++sizes[p];
+        q.total_edges = db.edges_.size();
+        for (std::size_t e = 0; e < q.total_edges; ++e)
+            if (part[db.edge_src(e)] != part[db.edge_dst(e)])
+                ++q.cut_edges;
+        q.largest = part.empty() ? 0 : *std::max_element(sizes.begin(), sizes.end());
+        q.balance = part.empty() ? 1 : q.largest * double(k) / part.size();
+        return q;
+    }
+
+private:
+    static std::size_t mix(std::size_t x) {
+        //std::hash of integers is the identity, spread consecutive ids over shards
+        std::uint64_t z = x + 0x9e3779b97f4a7c15ull;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return static_cast<std::size_t>(z ^ (z >> 31));
+    }
+};
+
+/**
+ * @brief A vertex copy in one shard, identified by the shard and the internal id inside it.
+ */
+struct shard_ref {
+    std::size_t shard;
+    std::size_t local;
+};
+
+/**
+ * @brief A graph database split into K independent graph_db shards.
+ * @tparam GraphSchema The schema of the database.
+ * @note Every vertex is owned by one shard, and every edge is stored in the shard owning its source.
+ * A destination owned by another shard is added to the source shard as a ghost vertex (a copy with the same user id and properties).
+ * Owned vertices of a shard have internal ids 0..owned_count()-1, and ghosts follow them.
+ * Shards are copies, later changes of the parent database are not reflected.
+ */
+template <class GraphSchema>
+class sharded_graph {
+public:
+    using db_t = graph_db<GraphSchema>;
+    using vertex_t = typename db_t::vertex_t;
+    using edge_t = typename db_t::edge_t;
+
+    /**
+     * @brief Splits the database by the assignment computed by partitioner.
+     */
+    sharded_graph(const db_t &db, const std::vector<std::size_t> &part, std::size_t k) : shards_(k), homes_(db.vertices_.size()), globals_(k), ghosts_(k), owned_(k, 0) {
+        if (part.size() != db.vertices_.size())
+            throw std::invalid_argument("partition does not cover the database");
+        for (auto &&shard : shards_)
+            shard = std::make_unique<db_t>();
+
+        for (std::size_t v = 0; v < db.vertices_.size(); ++v) {
+            std::size_t s = part[v];
+            if (s >= k)
+                throw std::invalid_argument("partition refers to a missing shard");
+            homes_[v] = shard_ref{ s, copy_vertex(db, s, v) };
+        }
+        for (std::size_t s = 0; s < k; ++s)
+            owned_[s] = globals_[s].size();
+
+        std::vector<std::unordered_map<std::size_t, std::size_t>> ghost_ids(k); //global id -> local ghost id
+        for (std::size_t v = 0; v < db.vertices_.size(); ++v) {
+            auto src = homes_[v];
+            auto &shard = *shards_[src.shard];
+            db.for_each_adjacent(v, [&](std::size_t e) {
+                std::size_t dst = db.edge_dst(e);
+                std::size_t local = homes_[dst].local;
+                if (homes_[dst].shard != src.shard) {
+                    auto it = ghost_ids[src.shard].find(dst);
+                    if (it == ghost_ids[src.shard].end()) {
+                        it = ghost_ids[src.shard].emplace(dst, copy_vertex(db, src.shard, dst)).first;
+                        ghosts_[src.shard].push_back(homes_[dst]);
+                    }
+                    local = it->second;
+                }
+                edge_t edge = db.edges_[e];
+                std::apply([&](auto &&...props) {
+                    shard.add_edge(db.edge_user_ids_[e], shard.vertices_[src.local], shard.vertices_[local], props...);
+                }, edge.get_properties());
+            });
+        }
+    }
+
+    std::size_t shard_count() const { return shards_.size(); }
+    db_t &shard(std::size_t s) { return *shards_[s]; }
+    const db_t &shard(std::size_t s) const { return *shards_[s]; }
+
+    std::size_t owned_count(std::size_t s) const { return owned_[s]; }
+    std::size_t ghost_count(std::size_t s) const { return ghosts_[s].size(); }
+    bool is_ghost(std::size_t s, std::size_t local) const { return local >= owned_[s]; }
+
+    /**
+     * @brief Returns the owning copy of a vertex of the shard, ghosts are resolved to their owner.
+     */
+    shard_ref home(std::size_t s, std::size_t local) const {
+        return is_ghost(s, local) ? ghosts_[s][local - owned_[s]] : shard_ref{ s, local };
+    }
+
+    /**
+     * @brief Returns the owning copy of a vertex of the parent database.
+     */
+    shard_ref locate(const vertex_t &v) const { return homes_[db_t::internal_id(v)]; }
+
+    /**
+     * @brief Returns the internal id in the parent database of a vertex of the shard.
+     */
+    std::size_t global_id(std::size_t s, std::size_t local) const { return globals_[s][local]; }
+
+    /**
+     * @brief Returns the internal id of a vertex inside its shard.
+     */
+    static std::size_t local_id(const vertex_t &v) { return db_t::internal_id(v); }
+
+    /**
+     * @brief Calls f(local destination id, edge) for every edge from the local vertex of the shard.
+     */
+    template <typename F>
+    void for_each_edge(std::size_t s, std::size_t local, F &&f) const {
+        const db_t &shard = *shards_[s];
+        shard.for_each_adjacent(local, [&](std::size_t e) { f(shard.edge_dst(e), edge_t(shard.edges_[e])); });
+    }
+
+private:
+    std::size_t copy_vertex(const db_t &db, std::size_t s, std::size_t v) {
+        auto &shard = *shards_[s];
+        vertex_t vertex = db.vertices_[v];
+        std::apply([&](auto &&...props) { shard.add_vertex(db.vertex_user_ids_[v], props...); }, vertex.get_properties());
+        globals_[s].push_back(v);
+        return globals_[s].size() - 1;
+    }
+
+    std::vector<std::unique_ptr<db_t>> shards_;
+    std::vector<shard_ref> homes_; //owning copy of every vertex of the parent database
+    std::vector<std::vector<std::size_t>> globals_; //[shard][local id] -> internal id in the parent database
+    std::vector<std::vector<shard_ref>> ghosts_; //[shard][local id - owned] -> owning copy of the ghost
+    std::vector<std::size_t> owned_;
+};
+
+/**
+ * @brief In-process message queues between shards run by threads.
+ * @tparam Message The type of messages.
+ * @note Every shard posts into its own outboxes, so posting needs no lock.
+ * Outboxes alternate between supersteps, so a shard may post while a slower one still drains the previous superstep.
+ */
+template <typename Message>
+class local_mailbox {
+public:
+    explicit local_mailbox(std::size_t shards)
+        : shards_(shards), barrier_(shards), rounds_(shards, 0), boxes_(2 * shards * shards) {
+        for (auto &&c : sent_)
+            c.store(0);
+    }
+
+    std::size_t shards() const { return shards_; }
+
+    /**
+     * @brief Posts a message to the local vertex dst of the shard to, it is received after the next sync().
+     */
+    void post(std::size_t from, std::size_t to, std::size_t dst, const Message &m) {
+        box(rounds_[from] % 2, from, to).emplace_back(dst, m);
+    }
+
+    /**
+     * @brief Waits for all shards and returns the number of messages posted by all of them in this superstep.
+     */
+    std::size_t sync(std::size_t shard, std::size_t posted) {
+        std::size_t round = rounds_[shard]++;
+        sent_[round % 3].fetch_add(posted);
+        barrier_.wait();
+        std::size_t total = sent_[round % 3].load();
+        //every shard has read the counter of the previous round before this barrier
+        sent_[(round + 2) % 3].store(0);
+        return total;
+    }
+
+    /**
+     * @brief Calls f(dst, message) for every message delivered to the shard by the last sync().
+     */
+    template <typename F>
+    void drain(std::size_t to, F &&f) {
+        std::size_t parity = (rounds_[to] + 1) % 2;
+        for (std::size_t from = 0; from < shards_; ++from) {
+            auto &b = box(parity, from, to);
+            for (auto &&m : b)
+                f(m.first, m.second);
+            b.clear();
+        }
+    }
+
+private:
+    std::vector<std::pair<std::size_t, Message>> &box(std::size_t parity, std::size_t from, std::size_t to) {
+        return boxes_[(parity * shards_ + from) * shards_ + to];
+    }
+
+    std::size_t shards_;
+    pregel_barrier barrier_;
+    std::vector<std::size_t> rounds_; //supersteps finished by every shard
+    std::vector<std::vector<std::pair<std::size_t, Message>>> boxes_; //[parity][from][to]
+    std::atomic<std::size_t> sent_[3];
+};
+
+/**
+ * @brief Message queues between shards in anonymous shared memory, for shards run by forked processes.
+ * @tparam Message The type of messages, it has to be trivially copyable.
+ * @note The mailbox has to be created before fork(), every process then runs one shard.
+ * Every pair of shards has a fixed capacity per superstep, post() throws std::length_error when it is exceeded.
+ * A failing shard (an overflowing post() or an explicit abort()) marks the mailbox as aborted, every shard
+ * waiting in sync() or calling it later then throws std::runtime_error instead of waiting for it forever.
+ */
+template <typename Message>
+class shm_mailbox {
+    static_assert(std::is_trivially_copyable<Message>::value, "shm_mailbox needs trivially copyable messages");
+
+    struct slot {
+        std::size_t dst;
+        Message message;
+    };
+    struct header {
+        //barrier of all shards, which can be left when a shard aborts (a pthread barrier can not)
+        std::atomic<std::size_t> arrivals;
+        std::atomic<std::size_t> phase;
+        std::atomic<bool> aborted;
+        std::atomic<std::size_t> sent[3];
+    };
+
+public:
+    shm_mailbox(std::size_t shards, std::size_t capacity) : shards_(shards), capacity_(capacity) {
+        static_assert(std::atomic<std::size_t>::is_always_lock_free && std::atomic<bool>::is_always_lock_free,
+                      "shared counters need lock-free atomics");
+        bytes_ = sizeof(header) + shards * sizeof(std::size_t) + 2 * shards * shards * box_bytes();
+        void *mem = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED)
+            throw std::runtime_error("shm_mailbox: mmap failed");
+        base_ = static_cast<char *>(mem);
+
+        //mmap returns zeroed memory, so all rounds and box sizes start at 0
+        header *h = new (base_) header;
+        h->arrivals.store(0);
+        h->phase.store(0);
+        h->aborted.store(false);
+        for (auto &&c : h->sent)
+            c.store(0);
+    }
+
+    shm_mailbox(const shm_mailbox &) = delete;
+    shm_mailbox &operator=(const shm_mailbox &) = delete;
+
+    ~shm_mailbox() {
+        munmap(base_, bytes_);
+    }
+
+    std::size_t shards() const { return shards_; }
+
+    /**
+     * @see local_mailbox::post
+     */
+    void post(std::size_t from, std::size_t to, std::size_t dst, const Message &m) {
+        std::size_t *size = box(rounds()[from] % 2, from, to);
+        if (*size == capacity_) {
+            abort();
+            throw std::length_error("shm_mailbox: box capacity exceeded");
+        }
+        slots(size)[(*size)++] = slot{ dst, m };
+    }
+
+    /**
+     * @brief Marks the mailbox as failed, all shards waiting in sync() or calling it later throw std::runtime_error.
+     * @note Called by a shard which can not finish its superstep, or by the parent process when a shard process died.
+     */
+    void abort() noexcept {
+        head()->aborted.store(true, std::memory_order_release);
+    }
+
+    bool aborted() const noexcept {
+        return head()->aborted.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @see local_mailbox::sync
+     */
+    std::size_t sync(std::size_t shard, std::size_t posted) {
+        header *h = head();
+        std::size_t round = rounds()[shard]++;
+        h->sent[round % 3].fetch_add(posted);
+        wait_all();
+        std::size_t total = h->sent[round % 3].load();
+        h->sent[(round + 2) % 3].store(0);
+        return total;
+    }
+
+    /**
+     * @see local_mailbox::drain
+     */
+    template <typename F>
+    void drain(std::size_t to, F &&f) {
+        std::size_t parity = (rounds()[to] + 1) % 2;
+        for (std::size_t from = 0; from < shards_; ++from) {
+            std::size_t *size = box(parity, from, to);
+            const slot *s = slots(size);
+            for (std::size_t i = 0; i < *size; ++i)
+                f(s[i].dst, s[i].message);
+            *size = 0;
+        }
+    }
+
+private:
+    void wait_all() {
+        //the last shard to arrive opens the next phase, the others wait for it unless a shard aborted
+        header *h = head();
+        std::size_t phase = h->phase.load(std::memory_order_acquire);
+        if (aborted())
+            throw std::runtime_error("shm_mailbox: a shard aborted");
+        if (h->arrivals.fetch_add(1, std::memory_order_acq_rel) + 1 == shards_) {
+            h->arrivals.store(0, std::memory_order_relaxed);
+            h->phase.store(phase + 1, std::memory_order_release);
+            return;
+        }
+        for (std::size_t i = 0; h->phase.load(std::memory_order_acquire) == phase; ++i) {
+            if (aborted())
+                throw std::runtime_error("shm_mailbox: a shard aborted");
+            if (i >= spin)
+                std::this_thread::yield();
+        }
+    }
+
+    static constexpr std::size_t spin = 4096;
+
+    std::size_t box_bytes() const {
+        //size counter followed by the slots, rounded to keep slots aligned
+        std::size_t a = std::max(alignof(slot), alignof(std::size_t));
+        std::size_t head = (sizeof(std::size_t) + a - 1) / a * a;
+        return (head + capacity_ * sizeof(slot) + a - 1) / a * a;
+    }
+
+    header *head() const { return reinterpret_cast<header *>(base_); }
+    std::size_t *rounds() const { return reinterpret_cast<std::size_t *>(base_ + sizeof(header)); }
+
+    std::size_t *box(std::size_t parity, std::size_t from, std::size_t to) const {
+        char *boxes = base_ + sizeof(header) + shards_ * sizeof(std::size_t);
+        return reinterpret_cast<std::size_t *>(boxes + ((parity * shards_ + from) * shards_ + to) * box_bytes());
+    }
+
+    slot *slots(std::size_t *size) const {
+        std::size_t a = std::max(alignof(slot), alignof(std::size_t));
+        return reinterpret_cast<slot *>(reinterpret_cast<char *>(size) + (sizeof(std::size_t) + a - 1) / a * a);
+    }
+
+    std::size_t shards_;
+    std::size_t capacity_;
+    std::size_t bytes_ = 0;
+    char *base_ = nullptr;
+};
+
+/**
+ * @brief The view of one shard passed to the vertex program of run_shard.
+ */
+template <class GraphSchema, typename Message, typename Mailbox>
+class shard_context {
+public:
+    using graph_t = sharded_graph<GraphSchema>;
+    using edge_t = typename graph_t::edge_t;
+
+    shard_context(const graph_t &graph, Mailbox &mailbox, std::size_t shard) : graph_(&graph), mailbox_(&mailbox), shard_(shard) {}
+
+    std::size_t shard() const { return shard_; }
+    std::size_t superstep() const { return superstep_; }
+    const graph_t &graph() const { return *graph_; }
+
+    /**
+     * @brief Sends a message to a local vertex of the shard, messages to ghosts go to their owning shard.
+     */
+    void send(std::size_t local, const Message &m) {
+        auto home = graph_->home(shard_, local);
+        mailbox_->post(shard_, home.shard, home.local, m);
+        ++posted_;
+    }
+
+    /**
+     * @brief Sends the message along every forward edge of the local vertex.
+     */
+    void send_to_neighbours(std::size_t local, const Message &m) {
+        graph_->for_each_edge(shard_, local, [this, &m](std::size_t dst, const edge_t &) { send(dst, m); });
+    }
+
+    /**
+     * @brief Calls f(edge) for every forward edge of the local vertex, f returns the message sent to the edge's destination.
+     */
+    template <typename F>
+    void send_along_edges(std::size_t local, F &&f) {
+        graph_->for_each_edge(shard_, local, [this, &f](std::size_t dst, const edge_t &e) { send(dst, f(e)); });
+    }
+
+private:
+    template <class GS, typename M, typename B, typename P>
+    friend std::size_t run_shard(const sharded_graph<GS> &, std::size_t, B &, P &&, std::size_t);
+
+    const graph_t *graph_;
+    Mailbox *mailbox_;
+    std::size_t shard_;
+    std::size_t superstep_ = 0;
+    std::size_t posted_ = 0;
+};
+
+/**
+ * @brief Runs the bulk synchronous vertex program program(context &, std::size_t local, const std::vector<Message> &) on one shard.
+ * @tparam Mailbox local_mailbox or shm_mailbox shared by all shards.
+ * @return The number of executed supersteps.
+ * @note Every shard has to be run concurrently by its own thread or process.
+ * The program is called for every owned vertex in the first superstep and then for owned vertices which received messages.
+ * The run stops when no message was sent in a superstep, or after the maximal number of supersteps.
+ */
+template <class GraphSchema, typename Message, typename Mailbox, typename Program>
+std::size_t run_shard(const sharded_graph<GraphSchema> &graph, std::size_t shard, Mailbox &mailbox, Program &&program, std::size_t max_supersteps) {
+    shard_context<GraphSchema, Message, Mailbox> ctx(graph, mailbox, shard);
+    std::size_t owned = graph.owned_count(shard);
+    std::vector<std::vector<Message>> inbox(owned);
+    std::vector<char> active(owned, 1);
+
+    while (ctx.superstep_ < max_supersteps) {
+        for (std::size_t v = 0; v < owned; ++v) {
+            if (!active[v])
+                continue;
+            program(ctx, v, inbox[v]);
+            inbox[v].clear();
+            active[v] = 0;
+        }
+        ++ctx.superstep_;
+        std::size_t total = mailbox.sync(shard, ctx.posted_);
+        ctx.posted_ = 0;
+        mailbox.drain(shard, [&](std::size_t dst, const Message &m) {
+            inbox[dst].push_back(m);
+            active[dst] = 1;
+        });
+        if (!total)
+            break;
+    }
+    return ctx.superstep_;
+}
+
+#endif //PARTITION_HPP
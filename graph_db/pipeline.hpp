@@ -0,0 +1,236 @@
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+
+/*
+Lazy traversal pipelines, e.g. db.vertices() | where<1>(gt(10)) | expand() | select<0>() | to_vector()
+with using namespace traversal (the adaptors are named like common functions, e.g. POSIX select).
+Every stage wraps the previous one into a single push loop: the source iterates and calls the next stage
+for each element, so no intermediate container is created and the stages inline into nested loops.
+A sink returns false to stop the traversal early (used by take).
+*/
+
+namespace traversal {
+
+template <typename T, class Run>
+class pipeline;
+
+template <typename T, class Run>
+pipeline<T, Run> make_pipeline(Run run) { return pipeline<T, Run>(std::move(run)); }
+
+/**
+ * @brief A lazily evaluated sequence of values of type T.
+ * @tparam Run A callable run(sink) pushing the values into sink(const T &) until it returns false.
+ */
+template <typename T, class Run>
+class pipeline {
+public:
+    using value_type = T;
+
+    explicit pipeline(Run run) : run_(std::move(run)) {}
+
+    /**
+     * @brief Pushes the values into sink(const T &), stops when it returns false.
+     * @return false if the sink stopped the traversal.
+     */
+    template <typename Sink>
+    bool run(Sink &&sink) const { return run_(sink); }
+
+    template <typename F>
+    void for_each(F &&f) const {
+        run([&f](const T &x) { f(x); return true; });
+    }
+
+    std::size_t count() const {
+        std::size_t n = 0;
+        run([&n](const T &) { ++n; return true; });
+        return n;
+    }
+
+    std::vector<T> to_vector() const {
+        std::vector<T> result;
+        run([&result](const T &x) { result.push_back(x); return true; });
+        return result;
+    }
+
+    T sum() const {
+        T s{};
+        run([&s](const T &x) { s += x; return true; });
+        return s;
+    }
+
+    /**
+     * @brief Applies an adaptor (where, filter, transform, select, expand, destinations, take) or a terminal.
+     */
+    template <class Adaptor>
+    friend auto operator|(const pipeline &p, const Adaptor &a) { return a(p); }
+
+private:
+    Run run_;
+};
+
+/**
+ * @brief A pipeline over [first, last) of any iterator, e.g. subgraph_view::get_vertexes().
+ */
+template <typename It>
+auto from(It first, It last) {
+    using T = std::decay_t<decltype(*first)>;
+    return make_pipeline<T>([first, last](auto &sink) {
+        for (It it = first; it != last; ++it)
+            if (!sink(*it))
+                return false;
+        return true;
+    });
+}
+
+template <typename It>
+auto from(const std::pair<It, It> &range) { return from(range.first, range.second); }
+
+namespace pipeline_detail {
+
+template <std::size_t I, typename Pred>
+struct where_t {
+    Pred pred;
+
+    template <typename T, class R>
+    auto operator()(const pipeline<T, R> &p) const {
+        return make_pipeline<T>([p, pred = pred](auto &sink) {
+            return p.run([&](const T &x) { return pred(x.template get_property<I>()) ? sink(x) : true; });
+        });
+    }
+};
+
+template <typename Pred>
+struct filter_t {
+    Pred pred;
+
+    template <typename T, class R>
+    auto operator()(const pipeline<T, R> &p) const {
+        return make_pipeline<T>([p, pred = pred](auto &sink) {
+            return p.run([&](const T &x) { return pred(x) ? sink(x) : true; });
+        });
+    }
+};
+
+template <typename F>
+struct transform_t {
+    F f;
+
+    template <typename T, class R>
+    auto operator()(const pipeline<T, R> &p) const {
+        using U = std::decay_t<std::invoke_result_t<const F &, const T &>>;
+        return make_pipeline<U>([p, f = f](auto &sink) {
+            return p.run([&](const T &x) { return sink(f(x)); });
+        });
+    }
+};
+
+template <std::size_t I>
+struct select_t {
+    template <typename T, class R>
+    auto operator()(const pipeline<T, R> &p) const {
+        using U = std::decay_t<decltype(std::declval<const T &>().template get_property<I>())>;
+        return make_pipeline<U>([p](auto &sink) {
+            return p.run([&](const T &x) { return sink(x.template get_property<I>()); });
+        });
+    }
+};
+
+struct expand_t {
+    template <typename T, class R>
+    auto operator()(const pipeline<T, R> &p) const {
+        using U = std::decay_t<decltype(*std::declval<typename T::neighbor_it_t &>())>;
+        return make_pipeline<U>([p](auto &sink) {
+            return p.run([&](const T &v) {
+                auto[begin, end] = v.edges();
+                for (; begin != end; ++begin)
+                    if (!sink(*begin))
+                        return false;
+                return true;
+            });
+        });
+    }
+};
+
+struct destinations_t {
+    template <typename T, class R>
+    auto operator()(const pipeline<T, R> &p) const {
+        using U = std::decay_t<decltype(std::declval<const T &>().dst())>;
+        return make_pipeline<U>([p](auto &sink) {
+            return p.run([&](const T &e) { return sink(e.dst()); });
+        });
+    }
+};
+
+struct take_t {
+    std::size_t n;
+
+    template <typename T, class R>
+    auto operator()(const pipeline<T, R> &p) const {
+        return make_pipeline<T>([p, n = n](auto &sink) {
+            std::size_t left = n;
+            if (!left)
+                return false;
+            return p.run([&](const T &x) { return sink(x) && --left != 0; });
+        });
+    }
+};
+
+} //namespace pipeline_detail
+
+/**
+ * @brief Keeps vertices/edges whose I-th property satisfies pred.
+ */
+template <std::size_t I, typename Pred>
+pipeline_detail::where_t<I, std::decay_t<Pred>> where(Pred &&pred) { return { std::forward<Pred>(pred) }; }
+
+/**
+ * @brief Keeps values satisfying pred.
+ */
+template <typename Pred>
+pipeline_detail::filter_t<std::decay_t<Pred>> filter(Pred &&pred) { return { std::forward<Pred>(pred) }; }
+
+/**
+ * @brief Maps every value by f.
+ */
+template <typename F>
+pipeline_detail::transform_t<std::decay_t<F>> transform(F &&f) { return { std::forward<F>(f) }; }
+
+/**
+ * @brief Maps vertices/edges to their I-th property.
+ */
+template <std::size_t I>
+pipeline_detail::select_t<I> select() { return {}; }
+
+/**
+ * @brief Maps every vertex to its forward edges.
+ */
+inline pipeline_detail::expand_t expand() { return {}; }
+
+/**
+ * @brief Maps every edge to its destination vertex.
+ */
+inline pipeline_detail::destinations_t destinations() { return {}; }
+
+/**
+ * @brief Stops after n values.
+ */
+inline pipeline_detail::take_t take(std::size_t n) { return { n }; }
+
+/**
+ * @brief Predicates comparing a value with v, for where and filter.
+ */
+template <typename T> auto eq(T v) { return [v](const auto &x) { return x == v; }; }
+template <typename T> auto ne(T v) { return [v](const auto &x) { return !(x == v); }; }
+template <typename T> auto lt(T v) { return [v](const auto &x) { return x < v; }; }
+template <typename T> auto le(T v) { return [v](const auto &x) { return !(v < x); }; }
+template <typename T> auto gt(T v) { return [v](const auto &x) { return v < x; }; }
+template <typename T> auto ge(T v) { return [v](const auto &x) { return !(x < v); }; }
+
+} //namespace traversal
+
+#endif //PIPELINE_HPP
@@ -0,0 +1,285 @@
+#ifndef PREGEL_HPP
+#define PREGEL_HPP
+
+#include "graph_db.hpp"
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <exception>
+
+template <class GraphSchema>
+class graph_db;
+template <class GraphSchema, typename State, typename Message>
+class pregel;
+
+/**
+ * @brief A reusable barrier for a fixed number of threads.
+ */
+class pregel_barrier {
+public:
+    explicit pregel_barrier(std::size_t count) : threshold_(count), count_(count) {}
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto generation = generation_;
+        if (!--count_) {
+            ++generation_;
+            count_ = threshold_;
+            cond_.notify_all();
+        } else {
+            cond_.wait(lock, [this, generation] { return generation != generation_; });
+        }
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::size_t threshold_;
+    std::size_t count_;
+    std::size_t generation_ = 0;
+};
+
+/**
+ * @brief Bulk synchronous (Pregel-style) vertex program engine over a graph database.
+ * @tparam GraphSchema The schema of the database.
+ * @tparam State A per-vertex state kept by the engine.
+ * @tparam Message The type of messages sent between vertices, it has to be default constructible.
+ * @note In every superstep the program is called for every vertex which has not voted to halt or has received messages.
+ * The run stops when all vertices voted to halt and no message is in flight, or after the maximal number of supersteps.
+ */
+template <class GraphSchema, typename State, typename Message>
+class pregel {
+public:
+    using db_t = graph_db<GraphSchema>;
+    using vertex_t = typename db_t::vertex_t;
+    using edge_t = typename db_t::edge_t;
+
+    /**
+     * @brief The view of one vertex passed to the vertex program.
+     */
+    class context {
+    public:
+        const vertex_t &vertex() const { return vertex_; }
+        State &state() { return engine_->states_[id_]; }
+        std::size_t superstep() const { return engine_->superstep_; }
+
+        /**
+         * @brief Sends a message to the given vertex, it is delivered in the next superstep.
+         */
+        void send(const vertex_t &dst, const Message &m) { engine_->post(thread_, db_t::internal_id(dst), m); }
+
+        /**
+         * @brief Sends the message along every forward edge of the vertex.
+         */
+        void send_to_neighbours(const Message &m) {
+            engine_->db_->for_each_adjacent(id_, [this, &m](std::size_t e) { engine_->post(thread_, engine_->db_->edge_dst(e), m); });
+        }
+
+        /**
+         * @brief Calls f(edge) for every forward edge, f returns the message sent to the edge's destination.
+         */
+        template <typename F>
+        void send_along_edges(F &&f) {
+            engine_->db_->for_each_adjacent(id_, [this, &f](std::size_t e) {
+                engine_->post(thread_, engine_->db_->edge_dst(e), f(edge_t(engine_->db_->edges_[e])));
+            });
+        }
+
+        /**
+         * @brief Deactivates the vertex until it receives a message.
+         */
+        void vote_to_halt() { engine_->halted_[id_] = 1; }
+
+    private:
+        friend class pregel;
+
+        context(pregel *engine, std::size_t thread, std::size_t id, const vertex_t &vertex) : engine_(engine), thread_(thread), id_(id), vertex_(vertex) {}
+
+        pregel *engine_;
+        std::size_t thread_;
+        std::size_t id_;
+        const vertex_t &vertex_;
+    };
+
+    /**
+     * @brief Creates the engine, every vertex state is initialized by init(vertex).
+     * @param thrs Number of worker threads.
+     */
+    template <typename Init>
+    pregel(const db_t &db, Init &&init, std::size_t thrs = std::thread::hardware_concurrency())
+        : db_(&db), thrs_(std::max<std::size_t>(1, std::min<std::size_t>(thrs, std::max<std::size_t>(1, db.vertices_.size())))) {
+        std::size_t n = db.vertices_.size();
+        states_.reserve(n);
+        for (auto &&v : db.vertices_)
+            states_.push_back(init(v));
+        halted_.assign(n, 0);
+        inbox_.resize(n);
+        has_combined_.assign(n, 0);
+        combined_.resize(n);
+    }
+
+    /**
+     * @brief Sets a commutative and associative function Message(Message, Message) merging messages to the same vertex.
+     * @note Every thread combines the messages it sends to the same vertex in its outbox (one slot per vertex and thread),
+     * and the owner of the vertex combines those of different threads while delivering them, so a vertex receives at most one message.
+     */
+    template <typename Combine>
+    void set_combiner(Combine &&combine) { combiner_ = std::forward<Combine>(combine); }
+
+    /**
+     * @brief Runs the vertex program program(context &, const std::vector<Message> &messages).
+     * @param max_supersteps The maximal number of supersteps.
+     * @return The number of executed supersteps.
+     */
+    template <typename Program>
+    std::size_t run(Program &&program, std::size_t max_supersteps) {
+        std::size_t n = states_.size();
+        outboxes_.assign(thrs_, std::vector<std::vector<std::pair<std::size_t, Message>>>(thrs_));
+        if (combiner_)
+            slots_.assign(thrs_, std::vector<std::size_t>(n, no_slot));
+        else
+            slots_.clear();
+        pregel_barrier barrier(thrs_);
+        std::atomic<std::size_t> active{0};
+        std::vector<std::exception_ptr> errors(thrs_);
+        bool done = false;
+        superstep_ = 0;
+
+        auto worker = [&](std::size_t t) {
+            std::size_t lo = range_begin(t, n), hi = range_begin(t + 1, n);
+            std::vector<Message> messages;
+            while (true) {
+                //compute
+                try {
+                    for (std::size_t v = lo; v < hi; ++v) {
+                        messages.clear();
+                        take_messages(v, messages);
+                        if (halted_[v] && messages.empty())
+                            continue;
+                        halted_[v] = 0;
+                        context ctx(this, t, v, db_->vertices_[v]);
+                        program(ctx, messages);
+                    }
+                } catch (...) {
+                    errors[t] = std::current_exception();
+                }
+                barrier.wait();
+
+                //deliver messages addressed to vertices of this thread
+                std::size_t delivered = 0;
+                for (std::size_t s = 0; s < thrs_; ++s) {
+                    auto &box = outboxes_[s][t];
+                    for (auto &&m : box) {
+                        if (combiner_)
+                            slots_[s][m.first] = no_slot;
+                        deliver(m.first, std::move(m.second));
+                    }
+                    delivered += box.size();
+                    box.clear();
+                }
+                for (std::size_t v = lo; v < hi; ++v)
+                    if (!halted_[v])
+                        ++delivered;
+                active.fetch_add(delivered, std::memory_order_relaxed);
+                barrier.wait();
+
+                if (t == 0) {
+                    ++superstep_;
+                    bool failed = std::any_of(errors.begin(), errors.end(), [](auto &&e) { return e != nullptr; });
+                    done = failed || active.load() == 0 || superstep_ >= max_supersteps;
+                    active.store(0);
+                }
+                barrier.wait();
+                if (done)
+                    break;
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (std::size_t t = 1; t < thrs_; ++t)
+            threads.emplace_back(worker, t);
+        worker(0);
+        for (auto &&th : threads)
+            th.join();
+
+        for (auto &&e : errors)
+            if (e)
+                std::rethrow_exception(e);
+        return superstep_;
+    }
+
+    const State &state(const vertex_t &v) const { return states_[db_t::internal_id(v)]; }
+    const std::vector<State> &states() const { return states_; }
+
+private:
+    std::size_t range_begin(std::size_t t, std::size_t n) const { return n * t / thrs_; }
+    std::size_t owner(std::size_t v) const {
+        //inverse of range_begin
+        std::size_t n = states_.size();
+        std::size_t t = v * thrs_ / n;
+        while (range_begin(t + 1, n) <= v)
+            ++t;
+        while (range_begin(t, n) > v)
+            --t;
+        return t;
+    }
+
+    void post(std::size_t thread, std::size_t dst, const Message &m) {
+        auto &box = outboxes_[thread][owner(dst)];
+        if (!combiner_) {
+            box.emplace_back(dst, m);
+            return;
+        }
+        //messages of one thread to the same vertex are combined already in its outbox
+        auto &slot = slots_[thread][dst];
+        if (slot == no_slot) {
+            slot = box.size();
+            box.emplace_back(dst, m);
+        } else {
+            box[slot].second = combiner_(box[slot].second, m);
+        }
+    }
+
+    void deliver(std::size_t dst, Message &&m) {
+        if (!combiner_) {
+            inbox_[dst].push_back(std::move(m));
+        } else if (has_combined_[dst]) {
+            combined_[dst] = combiner_(combined_[dst], m);
+        } else {
+            combined_[dst] = std::move(m);
+            has_combined_[dst] = 1;
+        }
+    }
+
+    void take_messages(std::size_t v, std::vector<Message> &messages) {
+        if (has_combined_[v]) {
+            messages.push_back(std::move(combined_[v]));
+            has_combined_[v] = 0;
+        }
+        if (!inbox_[v].empty()) {
+            messages.insert(messages.end(), std::make_move_iterator(inbox_[v].begin()), std::make_move_iterator(inbox_[v].end()));
+            inbox_[v].clear();
+        }
+    }
+
+    const db_t *db_;
+    std::size_t thrs_;
+    std::size_t superstep_ = 0;
+
+    std::vector<State> states_;
+    std::vector<char> halted_;
+    std::vector<std::vector<Message>> inbox_; //messages of the next superstep without combiner
+    std::vector<Message> combined_; //combined message of the next superstep
+    std::vector<char> has_combined_;
+    std::vector<std::vector<std::vector<std::pair<std::size_t, Message>>>> outboxes_; //[sender thread][owner thread]
+    std::vector<std::vector<std::size_t>> slots_; //[sender thread][vertex] position of the combined message in the outbox, only with combiner
+    static constexpr std::size_t no_slot = static_cast<std::size_t>(-1);
+    std::function<Message(const Message &, const Message &)> combiner_;
+};
+
+#endif //PREGEL_HPP
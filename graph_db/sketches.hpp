@@ -0,0 +1,268 @@
+#ifndef SKETCHES_HPP
+#define SKETCHES_HPP
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <utility>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+
+/*
+Approximate statistics of bounded size, all of them can be merged (e.g. sketches filled by threads or shards).
+*/
+
+inline std::uint64_t sketch_hash(std::uint64_t x) noexcept {
+    //splitmix64 finalizer, spreads consecutive ids over all bits
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief HyperLogLog estimate of the number of distinct values.
+ * @tparam Precision 2^Precision one byte registers, the relative error is about 1.04 / sqrt(2^Precision).
+ */
+template <std::size_t Precision>
+class hyperloglog {
+public:
+    static constexpr std::size_t registers = std::size_t(1) << Precision;
+
+    hyperloglog() noexcept { registers_.fill(0); }
+
+    void add(std::uint64_t value) noexcept {
+        std::uint64_t h = sketch_hash(value);
+        std::size_t r = static_cast<std::size_t>(h >> (64 - Precision));
+        std::uint64_t rest = h << Precision;
+        std::uint8_t rank = 1;
+        while (rank <= 64 - Precision && !(rest & (std::uint64_t(1) << 63))) {
+            rest <<= 1;
+            ++rank;
+        }
+        registers_[r] = std::max(registers_[r], rank);
+    }
+
+    void merge(const hyperloglog &other) noexcept {
+        for (std::size_t r = 0; r < registers; ++r)
+            registers_[r] = std::max(registers_[r], other.registers_[r]);
+    }
+
+    double estimate() const noexcept {
+        double sum = 0;
+        std::size_t zeros = 0;
+        for (auto reg : registers_) {
+            sum += std::ldexp(1.0, -static_cast<int>(reg));
+            zeros += reg == 0;
+        }
+        const double m = static_cast<double>(registers);
+        double e = alpha() * m * m / sum;
+        //small cardinalities are counted from the empty registers (linear counting)
+        if (e <= 2.5 * m && zeros)
+            e = m * std::log(m / static_cast<double>(zeros));
+        return e;
+    }
+
+private:
+    static constexpr double alpha() noexcept {
+        return registers == 16 ? 0.673 : registers == 32 ? 0.697 : registers == 64 ? 0.709 : 0.7213 / (1.0 + 1.079 / registers);
+    }
+
+    std::array<std::uint8_t, registers> registers_;
+};
+
+/**
+ * @brief Count-min sketch of counts of keys, estimates never undercount.
+ * @tparam Width Counters per row, the overcount is at most about 2.7 * total / Width with high probability.
+ * @tparam Depth Independent rows, the probability of a worse overcount falls exponentially with the depth.
+ * @tparam Candidates The number of keys with the largest estimates kept for heavy_hitters.
+ */
+template <std::size_t Width = 2048, std::size_t Depth = 4, std::size_t Candidates = 16>
+class count_min {
+public:
+    count_min() noexcept { counters_.fill(0); }
+
+    void add(std::uint64_t key, std::uint64_t n = 1) {
+        std::uint64_t h = sketch_hash(key);
+        std::uint64_t lo = static_cast<std::uint32_t>(h), hi = h >> 32;
+        for (std::size_t d = 0; d < Depth; ++d)
+            counters_[d * Width + (lo + d * hi) % Width] += n;
+        total_ += n;
+        offer(key, estimate(key));
+    }
+
+    std::uint64_t estimate(std::uint64_t key) const noexcept {
+        std::uint64_t h = sketch_hash(key);
+        std::uint64_t lo = static_cast<std::uint32_t>(h), hi = h >> 32;
+        std::uint64_t e = std::numeric_limits<std::uint64_t>::max();
+        for (std::size_t d = 0; d < Depth; ++d)
+            e = std::min(e, counters_[d * Width + (lo + d * hi) % Width]);
+        return e;
+    }
+
+    std::uint64_t total() const noexcept { return total_; }
+
+    /**
+     * @brief Returns the candidate keys estimated to reach at least fraction * total, the largest first.
+     */
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> heavy_hitters(double fraction) const {
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> result;
+        for (auto &&c : top_) {
+            std::uint64_t e = estimate(c.first);
+            if (e >= fraction * total_)
+                result.emplace_back(c.first, e);
+        }
+        std::sort(result.begin(), result.end(), [](auto &&a, auto &&b) { return a.second > b.second; });
+        return result;
+    }
+
+    void merge(const count_min &other) {
+        for (std::size_t i = 0; i < counters_.size(); ++i)
+            counters_[i] += other.counters_[i];
+        total_ += other.total_;
+        auto candidates = other.top_;
+        candidates.insert(candidates.end(), top_.begin(), top_.end());
+        top_.clear();
+        for (auto &&c : candidates)
+            offer(c.first, estimate(c.first));
+    }
+
+private:
+    void offer(std::uint64_t key, std::uint64_t e) {
+        //keeps the Candidates keys with the largest estimates seen so far
+        for (auto &&c : top_)
+            if (c.first == key) {
+                c.second = e;
+                return;
+            }
+        if (top_.size() < Candidates) {
+            top_.emplace_back(key, e);
+            return;
+        }
+        auto smallest = std::min_element(top_.begin(), top_.end(), [](auto &&a, auto &&b) { return a.second < b.second; });
+        if (smallest->second < e)
+            *smallest = { key, e };
+    }
+
+    std::array<std::uint64_t, Width * Depth> counters_;
+    std::uint64_t total_ = 0;
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> top_; //candidate key, estimate when last seen
+};
+
+/**
+ * @brief Sketches of a graph maintained by graph_db::add_edge once graph_db::enable_sketches() is called.
+ * @note Vertices are identified by internal ids. Sketches of graphs with the same vertex ids can be merged.
+ */
+class graph_sketches {
+public:
+    static constexpr std::size_t neighbour_precision = 6; //64 bytes per vertex, about 13 % error
+
+    using neighbour_sketch_t = hyperloglog<neighbour_precision>;
+
+    /**
+     * @brief Makes room for vertices 0..n-1, the new ones have no edges.
+     */
+    void resize(std::size_t n) {
+        if (n <= neighbours_.size())
+            return;
+        degree_counts(0) += n - neighbours_.size();
+        neighbours_.resize(n);
+        out_degrees_.resize(n, 0);
+    }
+
+    void vertex_added() { resize(neighbours_.size() + 1); }
+
+    void edge_added(std::size_t src, std::size_t dst) {
+        resize(std::max(src, dst) + 1);
+        neighbours_[src].add(dst);
+        --degree_counts_[out_degrees_[src]];
+        ++degree_counts(++out_degrees_[src]);
+        in_degrees_.add(dst);
+    }
+
+    /**
+     * @brief Estimated number of distinct destinations of edges from v.
+     */
+    double distinct_neighbours(std::size_t v) const noexcept {
+        return v < neighbours_.size() ? neighbours_[v].estimate() : 0.0;
+    }
+
+    /**
+     * @brief Estimated number of distinct vertices reachable from v by one or two edges.
+     */
+    double distinct_two_hop(std::size_t v, const std::vector<std::size_t> &destinations) const {
+        if (v >= neighbours_.size())
+            return 0.0;
+        neighbour_sketch_t reach = neighbours_[v];
+        for (auto d : destinations)
+            if (d < neighbours_.size())
+                reach.merge(neighbours_[d]);
+        return reach.estimate();
+    }
+
+    /**
+     * @brief Estimated in-degree of v, never smaller than the real one.
+     */
+    std::uint64_t in_degree(std::size_t v) const noexcept { return in_degrees_.estimate(v); }
+
+    /**
+     * @brief Vertices estimated to be destinations of at least fraction of all edges, the largest first.
+     */
+    std::vector<std::pair<std::size_t, std::uint64_t>> heavy_vertices(double fraction) const {
+        std::vector<std::pair<std::size_t, std::uint64_t>> result;
+        for (auto &&h : in_degrees_.heavy_hitters(fraction))
+            result.emplace_back(static_cast<std::size_t>(h.first), h.second);
+        return result;
+    }
+
+    /**
+     * @brief q-quantile of out-degrees over all vertices, including the ones without edges.
+     * @note Exact, read from the number of vertices of every degree which is kept up to date on every insertion,
+     * so the cost is linear in the largest degree and concurrent queries do not write anything.
+     * A t-digest does not fit here, it cannot forget the old degree of a vertex.
+     */
+    double degree_quantile(double q) const noexcept {
+        if (out_degrees_.empty())
+            return 0.0;
+        q = std::min(std::max(q, 0.0), 1.0);
+        auto rank = static_cast<std::uint64_t>(q * static_cast<double>(out_degrees_.size() - 1));
+        std::uint64_t below = 0;
+        std::size_t d = 0;
+        while (below + degree_counts_[d] <= rank)
+            below += degree_counts_[d++];
+        return static_cast<double>(d);
+    }
+
+    void merge(const graph_sketches &other) {
+        resize(other.neighbours_.size());
+        for (std::size_t v = 0; v < other.neighbours_.size(); ++v) {
+            neighbours_[v].merge(other.neighbours_[v]);
+            if (other.out_degrees_[v] == 0)
+                continue;
+            --degree_counts_[out_degrees_[v]];
+            out_degrees_[v] += other.out_degrees_[v];
+            ++degree_counts(out_degrees_[v]);
+        }
+        in_degrees_.merge(other.in_degrees_);
+    }
+
+    std::size_t bytes() const noexcept {
+        return neighbours_.capacity() * sizeof(neighbour_sketch_t) + out_degrees_.capacity() * sizeof(std::uint32_t)
+            + degree_counts_.capacity() * sizeof(std::uint64_t) + sizeof(in_degrees_);
+    }
+
+private:
+    std::uint64_t &degree_counts(std::size_t degree) {
+        if (degree >= degree_counts_.size())
+            degree_counts_.resize(degree + 1, 0);
+        return degree_counts_[degree];
+    }
+
+    std::vector<neighbour_sketch_t> neighbours_; //distinct destinations of every vertex
+    std::vector<std::uint32_t> out_degrees_;
+    std::vector<std::uint64_t> degree_counts_; //number of vertices of every out-degree
+    count_min<> in_degrees_;
+};
+
+#endif //SKETCHES_HPP
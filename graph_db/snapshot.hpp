@@ -0,0 +1,567 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include "graph_db.hpp"
+
+#include <vector>
+#include <string>
+#include <tuple>
+#include <thread>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <functional>
+#include <type_traits>
+#include <cstring>
+#include <cstdint>
+
+template <class GraphSchema>
+class graph_db;
+
+/**
+ * @brief Options of snapshot::save.
+ */
+struct snapshot_options {
+    bool compress = true; //compress every block by the built-in LZ codec
+    std::size_t block_size = 1 << 20; //bytes of raw data per compressed block
+};
+
+namespace snapshot_detail {
+
+//CRC-32 (IEEE 802.3) of a buffer
+inline std::uint32_t crc32(const std::uint8_t *data, std::size_t n, std::uint32_t crc = 0) noexcept {
+    static const auto table = [] {
+        std::vector<std::uint32_t> t(256);
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (std::size_t i = 0; i < n; ++i)
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+/*
+LZ77 block codec in the spirit of LZ4: a sequence is a token (4 bits literal length, 4 bits match length - 4),
+optional 255-run length extensions, the literals and a 16 bit match offset. The last sequence has literals only.
+*/
+constexpr std::size_t min_match = 4;
+constexpr std::size_t last_literals = 5;
+constexpr std::size_t max_ratio = 256; //raw bytes per stored byte can not exceed it (a 255 length extension byte is the best case)
+
+inline std::uint32_t read32(const std::uint8_t *p) noexcept {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline void put_length(std::vector<std::uint8_t> &out, std::size_t len) {
+    //extension of a length which did not fit into its 4 bits of the token
+    for (; len >= 255; len -= 255)
+        out.push_back(255);
+    out.push_back(static_cast<std::uint8_t>(len));
+}
+
+inline void put_sequence(std::vector<std::uint8_t> &out, const std::uint8_t *literals, std::size_t lit, std::size_t offset, std::size_t match) {
+    std::size_t ml = match ? match - min_match : 0;
+    out.push_back(static_cast<std::uint8_t>((std::min<std::size_t>(lit, 15) << 4) | std::min<std::size_t>(ml, 15)));
+    if (lit >= 15)
+        put_length(out, lit - 15);
+    out.insert(out.end(), literals, literals + lit);
+    if (!match)
+        return;
+    out.push_back(static_cast<std::uint8_t>(offset));
+    out.push_back(static_cast<std::uint8_t>(offset >> 8));
+    if (ml >= 15)
+        put_length(out, ml - 15);
+}
+
+inline std::vector<std::uint8_t> lz_compress(const std::uint8_t *src, std::size_t n) {
+    std::vector<std::uint8_t> out;
+    out.reserve(n / 2 + 16);
+    std::vector<std::uint32_t> table(1 << 12, 0); //position + 1 of the last occurrence of a 4 byte hash
+    std::size_t i = 0, anchor = 0;
+    while (n >= last_literals + min_match && i + min_match + last_literals <= n) {
+        std::uint32_t h = (read32(src + i) * 2654435761u) >> 20;
+        std::size_t cand = table[h];
+        table[h] = static_cast<std::uint32_t>(i + 1);
+        if (cand && i - (cand - 1) <= 0xffff && read32(src + cand - 1) == read32(src + i)) {
+            std::size_t m = cand - 1, len = min_match;
+            while (i + len + last_literals < n && src[m + len] == src[i + len])
+                ++len;
+            put_sequence(out, src + anchor, i - anchor, i - m, len);
+            i += len;
+            anchor = i;
+        } else {
+            ++i;
+        }
+    }
+    put_sequence(out, src + anchor, n - anchor, 0, 0);
+    return out;
+}
+
+inline std::size_t get_length(const std::uint8_t *&ip, const std::uint8_t *end, std::size_t len) {
+    if (len != 15)
+        return len;
+    std::uint8_t b;
+    do {
+        if (ip >= end)
+            throw std::runtime_error("snapshot: corrupted block");
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return len;
+}
+
+inline void lz_decompress(const std::uint8_t *src, std::size_t n, std::uint8_t *dst, std::size_t raw) {
+    const std::uint8_t *ip = src, *end = src + n;
+    std::size_t op = 0;
+    while (ip < end) {
+        std::uint8_t token = *ip++;
+        std::size_t lit = get_length(ip, end, token >> 4);
+        if (lit > static_cast<std::size_t>(end - ip) || lit > raw - op)
+            throw std::runtime_error("snapshot: corrupted block");
+        std::memcpy(dst + op, ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip == end)
+            break;
+        if (end - ip < 2)
+            throw std::runtime_error("snapshot: corrupted block");
+        std::size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        std::size_t len = get_length(ip, end, token & 15) + min_match;
+        if (!offset || offset > op || len > raw - op)
+            throw std::runtime_error("snapshot: corrupted block");
+        for (std::size_t k = 0; k < len; ++k, ++op) //byte by byte, the match may overlap the output
+            dst[op] = dst[op - offset];
+    }
+    if (op != raw)
+        throw std::runtime_error("snapshot: corrupted block");
+}
+
+//raw buffer of a section, values are in host byte order
+class writer {
+public:
+    template <typename T>
+    void put(const T &v) {
+        if constexpr (std::is_same<T, std::string>::value) {
+            put(static_cast<std::uint64_t>(v.size()));
+            bytes.insert(bytes.end(), v.begin(), v.end());
+        } else {
+            static_assert(std::is_trivially_copyable<T>::value, "Snapshot supports trivially copyable types and std::string");
+            auto p = reinterpret_cast<const std::uint8_t *>(&v);
+            bytes.insert(bytes.end(), p, p + sizeof(T));
+        }
+    }
+
+    std::vector<std::uint8_t> bytes;
+};
+
+class reader {
+public:
+    reader(const std::vector<std::uint8_t> &bytes) : bytes_(bytes) {}
+
+    std::size_t remaining() const noexcept { return bytes_.size() - pos_; }
+
+    void expect_end() const {
+        //the counts of the header are outside every CRC, a section has to hold exactly what they describe
+        if (pos_ != bytes_.size())
+            throw std::runtime_error("snapshot: section does not match the counts");
+    }
+
+    template <typename T>
+    T get() {
+        if constexpr (std::is_same<T, std::string>::value) {
+            auto n = get<std::uint64_t>();
+            check(n);
+            std::string s(reinterpret_cast<const char *>(bytes_.data() + pos_), n);
+            pos_ += n;
+            return s;
+        } else {
+            check(sizeof(T));
+            T v;
+            std::memcpy(&v, bytes_.data() + pos_, sizeof(T));
+            pos_ += sizeof(T);
+            return v;
+        }
+    }
+
+private:
+    void check(std::size_t n) const {
+        if (n > bytes_.size() - pos_)
+            throw std::runtime_error("snapshot: truncated section");
+    }
+
+    const std::vector<std::uint8_t> &bytes_;
+    std::size_t pos_ = 0;
+};
+
+struct section {
+    std::uint32_t id = 0;
+    std::uint32_t crc = 0; //checksum of raw content
+    std::uint64_t raw_size = 0;
+    std::vector<std::uint8_t> raw; //serialized content
+    std::vector<std::uint8_t> stored; //blocks as written to the stream
+};
+
+template <typename T>
+void write_pod(std::ostream &os, const T &v) {
+    os.write(reinterpret_cast<const char *>(&v), sizeof(T));
+}
+
+template <typename T>
+T read_pod(std::istream &is) {
+    T v;
+    if (!is.read(reinterpret_cast<char *>(&v), sizeof(T)))
+        throw std::runtime_error("snapshot: unexpected end of stream");
+    return v;
+}
+
+inline void read_bytes(std::istream &is, std::vector<std::uint8_t> &out, std::uint64_t n) {
+    //reads in chunks so that a corrupted size fails at the end of the stream instead of allocating it
+    constexpr std::uint64_t chunk = 1 << 20;
+    out.clear();
+    for (std::uint64_t done = 0; done < n;) {
+        std::size_t k = static_cast<std::size_t>(std::min(chunk, n - done));
+        out.resize(done + k);
+        if (!is.read(reinterpret_cast<char *>(out.data() + done), k))
+            throw std::runtime_error("snapshot: unexpected end of stream");
+        done += k;
+    }
+}
+
+inline void encode(section &s, const snapshot_options &opt) {
+    //splits raw content into blocks, each stored compressed if that makes it smaller
+    s.raw_size = s.raw.size();
+    s.crc = crc32(s.raw.data(), s.raw.size());
+    writer w;
+    for (std::size_t first = 0; first < s.raw.size(); first += opt.block_size) {
+        std::size_t n = std::min(opt.block_size, s.raw.size() - first);
+        std::vector<std::uint8_t> packed;
+        if (opt.compress)
+            packed = lz_compress(s.raw.data() + first, n);
+        bool use_packed = opt.compress && packed.size() < n;
+        w.put(static_cast<std::uint32_t>(n));
+        w.put(static_cast<std::uint32_t>(use_packed ? packed.size() : n));
+        if (use_packed)
+            w.bytes.insert(w.bytes.end(), packed.begin(), packed.end());
+        else
+            w.bytes.insert(w.bytes.end(), s.raw.begin() + first, s.raw.begin() + first + n);
+    }
+    s.stored = std::move(w.bytes);
+    std::vector<std::uint8_t>().swap(s.raw);
+}
+
+inline void decode(section &s) {
+    if (s.raw_size > s.stored.size() * max_ratio)
+        throw std::runtime_error("snapshot: corrupted section");
+    s.raw.resize(s.raw_size);
+    std::size_t op = 0, ip = 0;
+    while (op < s.raw_size) {
+        if (s.stored.size() - ip < 2 * sizeof(std::uint32_t))
+            throw std::runtime_error("snapshot: corrupted section");
+        std::uint32_t n = read32(s.stored.data() + ip);
+        std::uint32_t stored = read32(s.stored.data() + ip + sizeof(std::uint32_t));
+        ip += 2 * sizeof(std::uint32_t);
+        if (n == 0 || n > s.raw_size - op || stored > s.stored.size() - ip || stored > n || n > stored * max_ratio)
+            throw std::runtime_error("snapshot: corrupted section");
+        if (stored == n)
+            std::memcpy(s.raw.data() + op, s.stored.data() + ip, n);
+        else
+            lz_decompress(s.stored.data() + ip, stored, s.raw.data() + op, n);
+        op += n;
+        ip += stored;
+    }
+    if (crc32(s.raw.data(), s.raw.size()) != s.crc)
+        throw std::runtime_error("snapshot: checksum mismatch in section " + std::to_string(s.id));
+    std::vector<std::uint8_t>().swap(s.stored);
+}
+
+inline void run_parallel(std::vector<std::function<void()>> &jobs) {
+    //runs every job in its own thread, rethrows the first failure
+    std::vector<std::exception_ptr> errors(jobs.size());
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < jobs.size(); ++i)
+        threads.emplace_back([&jobs, &errors, i] {
+            try {
+                jobs[i]();
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    for (auto &&t : threads)
+        t.join();
+    for (auto &&e : errors)
+        if (e)
+            std::rethrow_exception(e);
+}
+
+} //namespace snapshot_detail
+
+/**
+ * @brief Binary checkpoint of a whole graph database: user ids, property collumns, edges and adjacency.
+ * @tparam GraphSchema The schema of the database. Properties and user ids have to be trivially copyable or std::string.
+ * @note Every collumn is a separate section with a CRC-32 checksum, sections are built and parsed by separate threads.
+ */
+template <class GraphSchema>
+class snapshot {
+public:
+    using db_t = graph_db<GraphSchema>;
+
+    /**
+     * @brief Writes the database into the stream.
+     */
+    static void save(const db_t &db, std::ostream &os, const snapshot_options &opt = {}) {
+        using namespace snapshot_detail;
+        std::vector<section> sections(fixed_sections + vertex_cols + edge_cols);
+        std::vector<std::function<void()>> jobs;
+
+        jobs.push_back([&] { write_vector(sections[0], vertex_ids_id, db.vertex_user_ids_, opt); });
+        jobs.push_back([&] { write_vector(sections[1], edge_ids_id, db.edge_user_ids_, opt); });
+        jobs.push_back([&] {
+            section &s = sections[2];
+            s.id = edges_id;
+            writer w;
+            for (std::size_t e = 0; e < db.edges_.size(); ++e) {
+                w.put(static_cast<std::uint64_t>(db.edge_src(e)));
+                w.put(static_cast<std::uint64_t>(db.edge_dst(e)));
+            }
+            finish(s, w, opt);
+        });
+        jobs.push_back([&] {
+            section &s = sections[3];
+            s.id = adjacency_id;
+            writer w;
+            w.put(static_cast<std::uint8_t>(db.adjacency_sorted_));
+            std::vector<std::uint64_t> list;
+            for (std::size_t v = 0; v < db.vertices_.size(); ++v) {
+                list.clear();
+                db.for_each_adjacent(v, [&list](std::size_t e) { list.push_back(e); });
+                w.put(static_cast<std::uint64_t>(list.size()));
+                for (auto e : list)
+                    w.put(e);
+            }
+            finish(s, w, opt);
+        });
+        add_column_jobs(jobs, sections, db, opt, std::make_index_sequence<vertex_cols>{}, std::make_index_sequence<edge_cols>{});
+
+        run_parallel(jobs);
+
+        os.write(magic, sizeof(magic));
+        write_pod(os, version);
+        write_pod(os, static_cast<std::uint64_t>(db.vertices_.size()));
+        write_pod(os, static_cast<std::uint64_t>(db.edges_.size()));
+        write_pod(os, static_cast<std::uint32_t>(sections.size()));
+        for (auto &&s : sections) {
+            write_pod(os, s.id);
+            write_pod(os, s.crc);
+            write_pod(os, s.raw_size);
+            write_pod(os, static_cast<std::uint64_t>(s.stored.size()));
+            os.write(reinterpret_cast<const char *>(s.stored.data()), s.stored.size());
+        }
+        if (!os)
+            throw std::runtime_error("snapshot: write failed");
+    }
+
+    /**
+     * @brief Reads a snapshot from the stream into an empty database.
+     * @throws std::runtime_error if the database is not empty or the snapshot is corrupted.
+     */
+    static void load(db_t &db, std::istream &is) {
+        using namespace snapshot_detail;
+        if (!db.vertices_.empty() || !db.edges_.empty())
+            throw std::runtime_error("snapshot: the database has to be empty");
+
+        char m[sizeof(magic)];
+        if (!is.read(m, sizeof(m)) || std::memcmp(m, magic, sizeof(magic)) != 0)
+            throw std::runtime_error("snapshot: not a graph_db snapshot");
+        if (read_pod<std::uint32_t>(is) != version)
+            throw std::runtime_error("snapshot: unsupported version");
+        auto vertex_count = read_pod<std::uint64_t>(is);
+        auto edge_count = read_pod<std::uint64_t>(is);
+        auto count = read_pod<std::uint32_t>(is);
+        if (count != fixed_sections + vertex_cols + edge_cols)
+            throw std::runtime_error("snapshot: schema does not match");
+
+        std::vector<section> sections(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            sections[i].id = read_pod<std::uint32_t>(is);
+            if (sections[i].id != section_id(i))
+                throw std::runtime_error("snapshot: unexpected section " + std::to_string(sections[i].id));
+            sections[i].crc = read_pod<std::uint32_t>(is);
+            sections[i].raw_size = read_pod<std::uint64_t>(is);
+            read_bytes(is, sections[i].stored, read_pod<std::uint64_t>(is));
+        }
+        //every edge has its two endpoints and every vertex the length of its adjacency list
+        if (edge_count > sections[2].raw_size / (2 * sizeof(std::uint64_t)) || vertex_count > sections[3].raw_size / sizeof(std::uint64_t))
+            throw std::runtime_error("snapshot: counts do not match the sections");
+
+        std::vector<std::function<void()>> jobs;
+        jobs.push_back([&] { read_vector(sections[0], db.vertex_user_ids_, vertex_count); });
+        jobs.push_back([&] { read_vector(sections[1], db.edge_user_ids_, edge_count); });
+        jobs.push_back([&] {
+            decode(sections[2]);
+            reader r(sections[2].raw);
+            db.edges_.reserve(edge_count);
+            for (std::size_t e = 0; e < edge_count; ++e) {
+                auto src = r.template get<std::uint64_t>();
+                auto dst = r.template get<std::uint64_t>();
+                if (src >= vertex_count || dst >= vertex_count)
+                    throw std::runtime_error("snapshot: edge out of range");
+                db.edges_.emplace_back(e, src, dst, &db);
+            }
+            r.expect_end();
+        });
+        jobs.push_back([&] {
+            decode(sections[3]);
+            reader r(sections[3].raw);
+            db.adjacency_sorted_ = r.template get<std::uint8_t>() != 0;
+            if (vertex_count > r.remaining() / sizeof(std::uint64_t))
+                throw std::runtime_error("snapshot: truncated section");
+            db.neighbours_.resize(vertex_count);
+            for (auto &&list : db.neighbours_) {
+                auto n = r.template get<std::uint64_t>();
+                if (n > r.remaining() / sizeof(std::uint64_t))
+                    throw std::runtime_error("snapshot: truncated section");
+                list.resize(n);
+                for (auto &&e : list) {
+                    e = r.template get<std::uint64_t>();
+                    if (e >= edge_count)
+                        throw std::runtime_error("snapshot: adjacency out of range");
+                }
+            }
+            r.expect_end();
+        });
+        //collumns are read in parallel into plain vectors and stored afterwards, grouped properties share their rows
+        typename column_vectors<typename GraphSchema::vertex_property_t>::type vertex_columns;
+        typename column_vectors<typename GraphSchema::edge_property_t>::type edge_columns;
+        add_read_jobs(jobs, sections, vertex_columns, edge_columns, vertex_count, edge_count,
+                      std::make_index_sequence<vertex_cols>{}, std::make_index_sequence<edge_cols>{});
+
+        try {
+            run_parallel(jobs);
+        } catch (...) {
+            reset(db);
+            throw;
+        }
+        assign_columns(db, vertex_columns, edge_columns, std::make_index_sequence<vertex_cols>{}, std::make_index_sequence<edge_cols>{});
+
+        db.vertices_.reserve(vertex_count);
+        for (std::size_t v = 0; v < vertex_count; ++v)
+            db.vertices_.emplace_back(v, &db);
+        if constexpr (edge_timestamp<GraphSchema>::enabled)
+            db.time_sorted_.assign(vertex_count, 0);
+        if (db.sketches_)
+            db.enable_sketches();
+    }
+
+private:
+    static constexpr std::size_t vertex_cols = std::tuple_size<typename GraphSchema::vertex_property_t>::value;
+    static constexpr std::size_t edge_cols = std::tuple_size<typename GraphSchema::edge_property_t>::value;
+    static constexpr std::size_t fixed_sections = 4;
+    static constexpr std::uint32_t version = 1;
+    static constexpr char magic[8] = { 'G', 'D', 'B', 'S', 'N', 'A', 'P', '\0' };
+
+    enum : std::uint32_t { vertex_ids_id = 1, edge_ids_id = 2, edges_id = 3, adjacency_id = 4, vertex_col_id = 0x100, edge_col_id = 0x200 };
+
+    static constexpr std::uint32_t section_id(std::size_t i) {
+        //fixed sections, vertex collumns and edge collumns in the order they are saved
+        constexpr std::uint32_t fixed[fixed_sections] = { vertex_ids_id, edge_ids_id, edges_id, adjacency_id };
+        if (i < fixed_sections)
+            return fixed[i];
+        if (i < fixed_sections + vertex_cols)
+            return vertex_col_id + static_cast<std::uint32_t>(i - fixed_sections);
+        return edge_col_id + static_cast<std::uint32_t>(i - fixed_sections - vertex_cols);
+    }
+
+    static void finish(snapshot_detail::section &s, snapshot_detail::writer &w, const snapshot_options &opt) {
+        s.raw = std::move(w.bytes);
+        snapshot_detail::encode(s, opt);
+    }
+
+    template <typename Vec>
+    static void write_vector(snapshot_detail::section &s, std::uint32_t id, const Vec &v, const snapshot_options &opt) {
+        s.id = id;
+        snapshot_detail::writer w;
+        for (auto &&item : v)
+            w.put(static_cast<typename Vec::value_type>(item));
+        finish(s, w, opt);
+    }
+
+    template <typename Vec>
+    static void read_vector(snapshot_detail::section &s, Vec &v, std::size_t count) {
+        snapshot_detail::decode(s);
+        snapshot_detail::reader r(s.raw);
+        //a string takes at least its 8 byte length
+        using T = typename Vec::value_type;
+        constexpr std::size_t min_bytes = std::is_same<T, std::string>::value ? sizeof(std::uint64_t) : sizeof(T);
+        if (count > r.remaining() / min_bytes)
+            throw std::runtime_error("snapshot: truncated section");
+        v.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+            v.push_back(r.template get<typename Vec::value_type>());
+        r.expect_end();
+    }
+
+    template <std::size_t ...VI, std::size_t ...EI>
+    static void add_column_jobs(std::vector<std::function<void()>> &jobs, std::vector<snapshot_detail::section> &sections,
+                                const db_t &db, const snapshot_options &opt, std::index_sequence<VI...>, std::index_sequence<EI...>) {
+        ( jobs.push_back([&] { write_column(sections[fixed_sections + VI], vertex_col_id + VI, db.vertex_cols_, opt, std::integral_constant<std::size_t, VI>{}); }), ... );
+        ( jobs.push_back([&] { write_column(sections[fixed_sections + vertex_cols + EI], edge_col_id + EI, db.edge_cols_, opt, std::integral_constant<std::size_t, EI>{}); }), ... );
+    }
+
+    template <typename Cols, std::size_t I>
+    static void write_column(snapshot_detail::section &s, std::uint32_t id, const Cols &cols, const snapshot_options &opt, std::integral_constant<std::size_t, I>) {
+        s.id = id;
+        snapshot_detail::writer w;
+        cols.template scan<I>([&w](const auto *values, std::size_t n, std::size_t) {
+            for (std::size_t i = 0; i < n; ++i)
+                w.put(values[i]);
+        });
+        finish(s, w, opt);
+    }
+
+    template <typename Tuple>
+    struct column_vectors;
+    template <typename ...Ts>
+    struct column_vectors<std::tuple<Ts...>> { using type = std::tuple<std::vector<Ts>...>; };
+
+    template <typename VertexColumns, typename EdgeColumns, std::size_t ...VI, std::size_t ...EI>
+    static void add_read_jobs(std::vector<std::function<void()>> &jobs, std::vector<snapshot_detail::section> &sections,
+                              VertexColumns &vertex_columns, EdgeColumns &edge_columns, std::size_t vertex_count, std::size_t edge_count,
+                              std::index_sequence<VI...>, std::index_sequence<EI...>) {
+        ( jobs.push_back([&, vertex_count] {
+            constexpr std::size_t i = fixed_sections + VI;
+            read_vector(sections[i], std::get<VI>(vertex_columns), vertex_count);
+        }), ... );
+        ( jobs.push_back([&, edge_count] {
+            constexpr std::size_t i = fixed_sections + vertex_cols + EI;
+            read_vector(sections[i], std::get<EI>(edge_columns), edge_count);
+        }), ... );
+    }
+
+    template <typename VertexColumns, typename EdgeColumns, std::size_t ...VI, std::size_t ...EI>
+    static void assign_columns(db_t &db, VertexColumns &vertex_columns, EdgeColumns &edge_columns, std::index_sequence<VI...>, std::index_sequence<EI...>) {
+        ( db.vertex_cols_.template assign_column<VI>(std::move(std::get<VI>(vertex_columns))), ... );
+        ( db.edge_cols_.template assign_column<EI>(std::move(std::get<EI>(edge_columns))), ... );
+    }
+
+    static void reset(db_t &db) {
+        //leaves the database empty after a failed load
+        db.vertex_user_ids_.clear();
+        db.edge_user_ids_.clear();
+        db.edges_.clear();
+        db.neighbours_.clear();
+        db.time_sorted_.clear();
+        db.vertex_cols_.clear();
+        db.edge_cols_.clear();
+    }
+};
+
+#endif //SNAPSHOT_HPP
@@ -0,0 +1,259 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <vector>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+/**
+ * @brief Counter and timing of a single database operation.
+ */
+struct op_stats {
+    std::uint64_t count = 0;
+    std::uint64_t total_ns = 0;
+};
+
+/**
+ * @brief Access counters and memory held by one property column.
+ */
+struct column_stats {
+    std::uint64_t gets = 0;
+    std::uint64_t sets = 0;
+    std::size_t bytes = 0; //capacity of the column in bytes
+};
+
+/**
+ * @brief A snapshot of the graph database statistics returned by graph_db::stats().
+ * @note Counters stay zero unless compiled with GRAPH_DB_STATS, byte sizes are always filled.
+ */
+struct db_stats {
+    bool enabled = false;
+
+    op_stats add_vertex;
+    op_stats add_edge;
+
+    std::uint64_t vertex_derefs = 0; //dereferences of vertex_it_t
+    std::uint64_t edge_derefs = 0; //dereferences of edge_it_t
+    std::uint64_t neighbour_derefs = 0; //dereferences of neighbor_it_t
+    std::uint64_t adjacency_reallocations = 0; //growths of a single adjacency list
+
+    std::vector<column_stats> vertex_columns;
+    std::vector<column_stats> edge_columns;
+    std::size_t adjacency_bytes = 0;
+
+    /**
+     * @brief Calls f(name, value) for every metric, suitable for exporting into a metrics pipeline.
+     */
+    template<typename F>
+    void export_metrics(F &&f) const {
+        f("graph_db.add_vertex.count", add_vertex.count);
+        f("graph_db.add_vertex.total_ns", add_vertex.total_ns);
+        f("graph_db.add_edge.count", add_edge.count);
+        f("graph_db.add_edge.total_ns", add_edge.total_ns);
+        f("graph_db.vertex_it.derefs", vertex_derefs);
+        f("graph_db.edge_it.derefs", edge_derefs);
+        f("graph_db.neighbor_it.derefs", neighbour_derefs);
+        f("graph_db.adjacency.reallocations", adjacency_reallocations);
+        f("graph_db.adjacency.bytes", static_cast<std::uint64_t>(adjacency_bytes));
+        export_columns("graph_db.vertex_col.", vertex_columns, f);
+        export_columns("graph_db.edge_col.", edge_columns, f);
+    }
+
+private:
+    template<typename F>
+    static void export_columns(const std::string &prefix, const std::vector<column_stats> &cols, F &f) {
+        for (std::size_t i = 0; i < cols.size(); ++i) {
+            std::string name = prefix + std::to_string(i);
+            f(name + ".gets", cols[i].gets);
+            f(name + ".sets", cols[i].sets);
+            f(name + ".bytes", static_cast<std::uint64_t>(cols[i].bytes));
+        }
+    }
+};
+
+#ifdef GRAPH_DB_STATS
+
+/**
+ * @brief Collects statistics of one database into per-thread counters which are merged by snapshot().
+ * @tparam VertexCols Number of vertex properties.
+ * @tparam EdgeCols Number of edge properties.
+ */
+template<std::size_t VertexCols, std::size_t EdgeCols>
+class stats_collector {
+
+    using counter_t = std::atomic<std::uint64_t>;
+
+    struct counters { //written only by its owning thread, read by snapshot()
+        std::thread::id owner;
+        counter_t add_vertex_count{0}, add_vertex_ns{0};
+        counter_t add_edge_count{0}, add_edge_ns{0};
+        counter_t vertex_derefs{0}, edge_derefs{0}, neighbour_derefs{0};
+        counter_t adjacency_reallocations{0};
+        std::array<counter_t, VertexCols> vertex_gets{}, vertex_sets{};
+        std::array<counter_t, EdgeCols> edge_gets{}, edge_sets{};
+    };
+
+public:
+    class scoped_timer { //adds elapsed time to the given counters when destroyed
+    public:
+        scoped_timer(counter_t &count, counter_t &ns) : count_(count), ns_(ns), start_(std::chrono::steady_clock::now()) {}
+        ~scoped_timer() {
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count();
+            bump(count_, 1);
+            bump(ns_, static_cast<std::uint64_t>(elapsed));
+        }
+    private:
+        counter_t &count_;
+        counter_t &ns_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    static constexpr bool enabled = true;
+
+    stats_collector() : id_(next_id()) {}
+    stats_collector(const stats_collector &) : id_(next_id()) {} //copied database starts with fresh counters
+    stats_collector &operator=(const stats_collector &) { return *this; }
+
+    scoped_timer time_add_vertex() const { auto &c = local(); return scoped_timer(c.add_vertex_count, c.add_vertex_ns); }
+    scoped_timer time_add_edge() const { auto &c = local(); return scoped_timer(c.add_edge_count, c.add_edge_ns); }
+
+    template<std::size_t I> void vertex_get() const { bump(local().vertex_gets[I], 1); }
+    template<std::size_t I> void vertex_set() const { bump(local().vertex_sets[I], 1); }
+    template<std::size_t I> void edge_get() const { bump(local().edge_gets[I], 1); }
+    template<std::size_t I> void edge_set() const { bump(local().edge_sets[I], 1); }
+
+    void vertex_get_all() const { auto &c = local(); for (auto &&g : c.vertex_gets) bump(g, 1); }
+    void vertex_set_all() const { auto &c = local(); for (auto &&s : c.vertex_sets) bump(s, 1); }
+    void edge_get_all() const { auto &c = local(); for (auto &&g : c.edge_gets) bump(g, 1); }
+    void edge_set_all() const { auto &c = local(); for (auto &&s : c.edge_sets) bump(s, 1); }
+
+    void vertex_deref() const { bump(local().vertex_derefs, 1); }
+    void edge_deref() const { bump(local().edge_derefs, 1); }
+    void neighbour_deref() const { bump(local().neighbour_derefs, 1); }
+
+    template<typename Vec, typename T>
+    void push_adjacency(Vec &list, T &&value) const {
+        auto capacity = list.capacity();
+        list.push_back(std::forward<T>(value));
+        if (list.capacity() != capacity)
+            bump(local().adjacency_reallocations, 1);
+    }
+
+    /**
+     * @brief Merges the counters of all threads into the snapshot.
+     */
+    void snapshot(db_stats &s) const {
+        s.enabled = true;
+        s.vertex_columns.resize(VertexCols);
+        s.edge_columns.resize(EdgeCols);
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &&c : per_thread_) {
+            s.add_vertex.count += read(c->add_vertex_count);
+            s.add_vertex.total_ns += read(c->add_vertex_ns);
+            s.add_edge.count += read(c->add_edge_count);
+            s.add_edge.total_ns += read(c->add_edge_ns);
+            s.vertex_derefs += read(c->vertex_derefs);
+            s.edge_derefs += read(c->edge_derefs);
+            s.neighbour_derefs += read(c->neighbour_derefs);
+            s.adjacency_reallocations += read(c->adjacency_reallocations);
+            for (std::size_t i = 0; i < VertexCols; ++i) {
+                s.vertex_columns[i].gets += read(c->vertex_gets[i]);
+                s.vertex_columns[i].sets += read(c->vertex_sets[i]);
+            }
+            for (std::size_t i = 0; i < EdgeCols; ++i) {
+                s.edge_columns[i].gets += read(c->edge_gets[i]);
+                s.edge_columns[i].sets += read(c->edge_sets[i]);
+            }
+        }
+    }
+
+private:
+    static std::uint64_t next_id() {
+        static std::atomic<std::uint64_t> ids{1};
+        return ids.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void bump(counter_t &c, std::uint64_t v) {
+        //single writer per counter, so no locked read-modify-write is needed
+        c.store(c.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+    }
+
+    static std::uint64_t read(const counter_t &c) { return c.load(std::memory_order_relaxed); }
+
+    counters &local() const {
+        //one-entry cache keyed by collector id, ids are never reused so a stale entry cannot match
+        thread_local std::uint64_t cached_id = 0;
+        thread_local counters *cached = nullptr;
+        if (cached_id == id_)
+            return *cached;
+
+        auto me = std::this_thread::get_id();
+        std::lock_guard<std::mutex> lock(mutex_);
+        counters *found = nullptr;
+        for (auto &&c : per_thread_)
+            if (c->owner == me)
+                found = c.get();
+        if (!found) {
+            per_thread_.push_back(std::make_unique<counters>());
+            found = per_thread_.back().get();
+            found->owner = me;
+        }
+        cached_id = id_;
+        cached = found;
+        return *found;
+    }
+
+    std::uint64_t id_;
+    mutable std::mutex mutex_;
+    mutable std::vector<std::unique_ptr<counters>> per_thread_;
+};
+
+#else
+
+/**
+ * @brief Disabled statistics, every hook compiles to nothing. Define GRAPH_DB_STATS to enable.
+ */
+template<std::size_t VertexCols, std::size_t EdgeCols>
+class stats_collector {
+public:
+    struct scoped_timer {
+        ~scoped_timer() {} //user provided so that unused timers do not warn
+    };
+
+    static constexpr bool enabled = false;
+
+    scoped_timer time_add_vertex() const { return {}; }
+    scoped_timer time_add_edge() const { return {}; }
+
+    template<std::size_t I> void vertex_get() const {}
+    template<std::size_t I> void vertex_set() const {}
+    template<std::size_t I> void edge_get() const {}
+    template<std::size_t I> void edge_set() const {}
+
+    void vertex_get_all() const {}
+    void vertex_set_all() const {}
+    void edge_get_all() const {}
+    void edge_set_all() const {}
+
+    void vertex_deref() const {}
+    void edge_deref() const {}
+    void neighbour_deref() const {}
+
+    template<typename Vec, typename T>
+    void push_adjacency(Vec &list, T &&value) const { list.push_back(std::forward<T>(value)); }
+
+    void snapshot(db_stats &s) const {
+        s.vertex_columns.resize(VertexCols);
+        s.edge_columns.resize(EdgeCols);
+    }
+};
+
+#endif //GRAPH_DB_STATS
+
+#endif //STATS_HPP
@@ -0,0 +1,279 @@
+#ifndef SUBGRAPH_VIEW_HPP
+#define SUBGRAPH_VIEW_HPP
+
+#include "graph_db.hpp"
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+template <class GraphSchema>
+class graph_db;
+
+/**
+ * @brief A growable set of internal ids stored as one bit per id.
+ * @note set() and reset() throw std::out_of_range for ids >= size(), test() returns false for them.
+ */
+class id_bitmap {
+public:
+    void resize(std::size_t n) { words_.resize((n + 63) / 64, 0); size_ = n; }
+    std::size_t size() const noexcept { return size_; }
+
+    bool test(std::size_t i) const noexcept { return i < size_ && (words_[i / 64] >> (i % 64)) & 1; }
+    void set(std::size_t i) { check(i); words_[i / 64] |= std::uint64_t(1) << (i % 64); }
+    void reset(std::size_t i) { check(i); words_[i / 64] &= ~(std::uint64_t(1) << (i % 64)); }
+
+    std::size_t next(std::size_t i) const noexcept {
+        //returns the first set bit >= i or size() if there is none
+        if (i >= size_)
+            return size_;
+        std::size_t w = i / 64;
+        std::uint64_t bits = words_[w] & (~std::uint64_t(0) << (i % 64));
+        while (!bits) {
+            if (++w == words_.size())
+                return size_;
+            bits = words_[w];
+        }
+        std::size_t found = w * 64 + __builtin_ctzll(bits);
+        return found < size_ ? found : size_;
+    }
+
+    std::size_t count() const noexcept {
+        std::size_t c = 0;
+        for (auto w : words_)
+            c += __builtin_popcountll(w);
+        return c;
+    }
+
+    std::size_t bytes() const noexcept { return words_.capacity() * sizeof(std::uint64_t); }
+
+private:
+    void check(std::size_t i) const {
+        if (i >= size_)
+            throw std::out_of_range("id_bitmap: id " + std::to_string(i) + " out of range");
+    }
+
+    std::vector<std::uint64_t> words_;
+    std::size_t size_ = 0;
+};
+
+/**
+ * @brief A subgraph in compressed sparse row form produced by subgraph_view::materialize().
+ * @note Vertices are numbered 0..n-1 in the order of their internal ids in the parent database.
+ */
+struct subgraph_csr {
+    std::vector<std::size_t> vertices; //internal id in the parent database of every local vertex
+    std::vector<std::size_t> offsets; //edges of local vertex v are [offsets[v], offsets[v+1])
+    std::vector<std::size_t> targets; //local id of the destination of every edge
+    std::vector<std::size_t> edges; //internal id in the parent database of every edge
+
+    std::size_t vertex_count() const noexcept { return vertices.size(); }
+    std::size_t edge_count() const noexcept { return targets.size(); }
+};
+
+/**
+ * @brief A read-only view of a subgraph of a graph database, it selects vertices and masks edges without copying any property.
+ * @tparam GraphSchema The schema of the viewed database.
+ * @note An edge is visible if both its endpoints are selected and it is not masked.
+ * The view sees only vertices and edges which existed when it was created.
+ */
+template <class GraphSchema>
+class subgraph_view {
+public:
+    using db_t = graph_db<GraphSchema>;
+    using vertex_t = typename db_t::vertex_t;
+    using edge_t = typename db_t::edge_t;
+
+    class vertex_iterator { //iterates selected vertices in insertion order
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = vertex_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = vertex_t;
+
+        vertex_iterator(const subgraph_view *view, std::size_t index) : view_(view), index_(view->vertices_.next(index)) {}
+
+        vertex_iterator &operator++() {
+            index_ = view_->vertices_.next(index_ + 1);
+            return *this;
+        }
+        vertex_iterator operator++(int) {
+            vertex_iterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        vertex_t operator*() const { return view_->db_->vertices_[index_]; }
+
+        bool operator!=(const vertex_iterator &it2) const { return index_ != it2.index_; }
+        bool operator==(const vertex_iterator &it2) const { return index_ == it2.index_; }
+
+    private:
+        const subgraph_view *view_;
+        std::size_t index_;
+    };
+
+    class neighbor_iterator { //iterates visible edges of one vertex, skips the others
+    public:
+        using base_it_t = typename db_t::neighbor_it_t;
+
+        using iterator_category = std::input_iterator_tag;
+        using value_type = edge_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = edge_t;
+
+        neighbor_iterator(const subgraph_view *view, base_it_t it, base_it_t end) : view_(view), it_(it), end_(end) { skip(); }
+
+        neighbor_iterator &operator++() {
+            ++it_;
+            skip();
+            return *this;
+        }
+        neighbor_iterator operator++(int) {
+            neighbor_iterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        edge_t operator*() const { return *it_; }
+
+        bool operator!=(const neighbor_iterator &it2) const { return it_ != it2.it_; }
+        bool operator==(const neighbor_iterator &it2) const { return !(it_ != it2.it_); }
+
+    private:
+        void skip() {
+            while (it_ != end_ && !view_->visible(db_t::internal_id(*it_)))
+                ++it_;
+        }
+
+        const subgraph_view *view_;
+        base_it_t it_, end_;
+    };
+
+    using vertex_it_t = vertex_iterator;
+    using neighbor_it_t = neighbor_iterator;
+
+    /**
+     * @brief Creates an empty view (no vertex selected, no edge masked) of the database.
+     */
+    explicit subgraph_view(const db_t &db) : db_(&db) {
+        vertices_.resize(db.vertices_.size());
+        masked_edges_.resize(db.edges_.size());
+    }
+
+    /**
+     * @brief Selects a vertex, deselect() removes it again.
+     * @throws std::out_of_range if the vertex was added to the database after the view was created.
+     */
+    void select(const vertex_t &v) { vertices_.set(db_t::internal_id(v)); }
+    void deselect(const vertex_t &v) { vertices_.reset(db_t::internal_id(v)); }
+    bool contains(const vertex_t &v) const { return vertices_.test(db_t::internal_id(v)); }
+
+    /**
+     * @brief Hides an edge, unmask() shows it again.
+     * @throws std::out_of_range if the edge was added to the database after the view was created.
+     */
+    void mask(const edge_t &e) { masked_edges_.set(db_t::internal_id(e)); }
+    void unmask(const edge_t &e) { masked_edges_.reset(db_t::internal_id(e)); }
+    bool contains(const edge_t &e) const { return visible(db_t::internal_id(e)); }
+
+    /**
+     * @brief Selects every vertex whose I-th property satisfies pred.
+     * @note Reads the property collumn block by block, compressed collumns are not decompressed.
+     */
+    template <std::size_t I, typename Pred>
+    void select_where(Pred &&pred) {
+        db_->template scan_vertex_column<I>([this, &pred](const auto *values, std::size_t n, std::size_t first) {
+            for (std::size_t i = 0; i < n && first + i < vertices_.size(); ++i)
+                if (pred(values[i]))
+                    vertices_.set(first + i);
+        });
+    }
+
+    /**
+     * @brief Masks every edge whose I-th property does not satisfy pred.
+     */
+    template <std::size_t I, typename Pred>
+    void mask_unless(Pred &&pred) {
+        db_->template scan_edge_column<I>([this, &pred](const auto *values, std::size_t n, std::size_t first) {
+            for (std::size_t i = 0; i < n && first + i < masked_edges_.size(); ++i)
+                if (!pred(values[i]))
+                    masked_edges_.set(first + i);
+        });
+    }
+
+    std::size_t vertex_count() const { return vertices_.count(); }
+
+    /**
+     * @brief Returns begin() and end() iterators to all selected vertices.
+     * @see graph_db::get_vertexes
+     */
+    std::pair<vertex_it_t, vertex_it_t> get_vertexes() const {
+        return std::make_pair(vertex_it_t(this, 0), vertex_it_t(this, vertices_.size()));
+    }
+
+    /**
+     * @brief Returns begin() and end() iterators to all visible forward edges from the vertex.
+     * @see vertex::edges
+     */
+    std::pair<neighbor_it_t, neighbor_it_t> edges(const vertex_t &v) const {
+        auto[begin, end] = v.edges();
+        if (!contains(v))
+            begin = end;
+        return std::make_pair(neighbor_it_t(this, begin, end), neighbor_it_t(this, end, end));
+    }
+
+    /**
+     * @brief Copies the topology of the view into a compact CSR, properties stay in the parent database.
+     */
+    subgraph_csr materialize() const {
+        subgraph_csr csr;
+        std::vector<std::size_t> local(vertices_.size(), 0);
+        for (std::size_t v = vertices_.next(0); v < vertices_.size(); v = vertices_.next(v + 1)) {
+            local[v] = csr.vertices.size();
+            csr.vertices.push_back(v);
+        }
+        csr.offsets.reserve(csr.vertices.size() + 1);
+        csr.offsets.push_back(0);
+        for (auto v : csr.vertices) {
+            db_->for_each_adjacent(v, [&](std::size_t e) {
+                if (visible(e)) {
+                    csr.targets.push_back(local[db_->edge_dst(e)]);
+                    csr.edges.push_back(e);
+                }
+            });
+            csr.offsets.push_back(csr.targets.size());
+        }
+        return csr;
+    }
+
+    /**
+     * @brief Returns the vertex of the parent database for a local vertex of a materialized subgraph.
+     */
+    vertex_t vertex_of(const subgraph_csr &csr, std::size_t local) const { return db_->vertices_[csr.vertices[local]]; }
+
+    /**
+     * @brief Returns the edge of the parent database for a local edge of a materialized subgraph.
+     */
+    edge_t edge_of(const subgraph_csr &csr, std::size_t local) const { return db_->edges_[csr.edges[local]]; }
+
+    std::size_t bytes() const { return vertices_.bytes() + masked_edges_.bytes(); }
+
+private:
+    bool visible(std::size_t e) const {
+        return e < masked_edges_.size() && !masked_edges_.test(e)
+            && vertices_.test(db_->edge_src(e)) && vertices_.test(db_->edge_dst(e));
+    }
+
+    const db_t *db_;
+    id_bitmap vertices_; //selected vertices
+    id_bitmap masked_edges_; //edges hidden even if both endpoints are selected
+};
+
+#endif //SUBGRAPH_VIEW_HPP
@@ -0,0 +1,24 @@
+#ifndef TEMPORAL_HPP
+#define TEMPORAL_HPP
+
+#include <tuple>
+#include <type_traits>
+
+/**
+ * @brief Detects the edge timestamp collumn of a schema.
+ * @note A schema declares it by static constexpr std::size_t edge_timestamp_index, the index of an edge property.
+ * Adjacency lists of such a database are kept sorted by the timestamp, see vertex::edges_between.
+ */
+template <class GraphSchema, typename = void>
+struct edge_timestamp {
+    static constexpr bool enabled = false;
+};
+
+template <class GraphSchema>
+struct edge_timestamp<GraphSchema, std::void_t<decltype(GraphSchema::edge_timestamp_index)>> {
+    static constexpr bool enabled = true;
+    static constexpr std::size_t index = GraphSchema::edge_timestamp_index;
+    using type = std::tuple_element_t<index, typename GraphSchema::edge_property_t>;
+};
+
+#endif //TEMPORAL_HPP
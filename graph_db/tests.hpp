@@ -10,6 +10,15 @@
 #include <cstdint>
 #include <iostream>
 #include <type_traits>
+#include <sstream>
+#include <map>
+#include <cmath>
+#include <numeric>
+#include <iterator>
+#include <thread>
+#include <cerrno>
+#include <sys/wait.h>
+#include <unistd.h>
 
 
 class test_bench {
@@ -91,10 +100,1023 @@ class test_bench {
         }
     };
 
+    class test_stats {
+        struct gs {
+            using vertex_user_id_t = int;
+            using vertex_property_t = std::tuple<int, double>;
+
+            using edge_user_id_t = int;
+            using edge_property_t = std::tuple<bool>;
+        };
+        using gdb_t = graph_db<gs>;
+        gdb_t gdb;
+
+    public:
+        void run() {
+            auto v1 = gdb.add_vertex(1, 10, 1.5);
+            auto v2 = gdb.add_vertex(2);
+            v2.set_property<1>(2.5);
+            gdb.add_edge(1, v1, v2, true);
+            gdb.add_edge(2, v2, v1);
+
+            auto[vertexes_begin, vertexes_end] = gdb.get_vertexes();
+            std::for_each(vertexes_begin, vertexes_end, [](auto &&vertex) {
+                auto[neigbor_edges_begin, neighbor_edges_end] = vertex.edges();
+                std::for_each(neigbor_edges_begin, neighbor_edges_end, [](auto &&edge) {
+                    edge.template get_property<0>();
+                });
+                vertex.template get_property<1>();
+            });
+
+            auto s = gdb.stats();
+            assert(s.vertex_columns.size() == 2 && s.edge_columns.size() == 1);
+            assert(s.vertex_columns[0].bytes >= 2 * sizeof(int));
+            assert(s.adjacency_bytes >= 2 * sizeof(std::size_t));
+            if (s.enabled) {
+                assert(s.add_vertex.count == 2 && s.add_edge.count == 2);
+                assert(s.vertex_derefs == 2 && s.neighbour_derefs == 2);
+                assert(s.vertex_columns[1].gets == 2 && s.vertex_columns[1].sets == 2);
+                assert(s.edge_columns[0].gets == 2 && s.edge_columns[0].sets == 1);
+            }
+
+            std::size_t metrics = 0;
+            s.export_metrics([&metrics](const std::string &, std::uint64_t) { ++metrics; });
+            std::cout << "stats: " << metrics << " metrics exported\n";
+        }
+    };
+
+    class test_compression {
+        struct gs {
+            using vertex_user_id_t = int;
+            using vertex_property_t = std::tuple<std::string, int, char, bool>;
+
+            using edge_user_id_t = int;
+            using edge_property_t = std::tuple<long>;
+        };
+        using gdb_t = graph_db<gs>;
+        gdb_t gdb;
+
+        static constexpr int count = 1000;
+
+        void fill() {
+            for (int i = 0; i < count; ++i)
+                gdb.add_vertex(i, std::string(i % 3 ? 4 : 40, 'x'), 1000 + i % 50 - 25, i % 2 ? 'a' : 'b', i < count / 2);
+        }
+
+        template<std::size_t I, typename T>
+        T sum_column() const {
+            T sum{};
+            gdb.scan_vertex_column<I>([&sum](const auto *values, std::size_t n, std::size_t) {
+                for (std::size_t i = 0; i < n; ++i)
+                    sum += values[i];
+            });
+            return sum;
+        }
+
+    public:
+        void run() {
+            fill();
+            long int_sum = sum_column<1, long>();
+            long char_sum = sum_column<2, long>();
+            long bool_sum = sum_column<3, long>();
+            auto before = gdb.memory_usage();
+            assert(before.vertex_columns.size() == 4);
+            assert(before.vertex_columns[0].heap_bytes > 0);
+            assert(before.vertex_user_ids.used_bytes == count * sizeof(int));
+
+            gdb.compress_vertex_column<1>();
+            gdb.compress_vertex_column<2>();
+            gdb.compress_vertex_column<3>();
+            auto after = gdb.memory_usage();
+            assert(after.vertex_columns[1].total() < before.vertex_columns[1].total() / 4);
+            assert(after.vertex_columns[2].total() < before.vertex_columns[2].total() / 4);
+            assert((sum_column<1, long>() == int_sum));
+            assert((sum_column<2, long>() == char_sum));
+            assert((sum_column<3, long>() == bool_sum));
+
+            auto[vertexes_begin, vertexes_end] = gdb.get_vertexes();
+            auto v = *vertexes_begin;
+            assert(std::get<2>(v.get_properties()) == 'b');
+            assert(gdb.memory_usage().vertex_columns[2].compressed_bytes > 0);
+            assert(v.read_property<1>() == 975); //copies are read from the compressed collumn
+            assert(gdb.memory_usage().vertex_columns[1].compressed_bytes > 0);
+            assert(v.get_property<1>() == 975); //a reference decompresses it
+            assert(gdb.memory_usage().vertex_columns[1].compressed_bytes == 0);
+            assert(gdb.memory_usage().vertex_columns[3].compressed_bytes > 0);
+            gdb.decompress_vertex_column<3>();
+            assert(gdb.memory_usage().vertex_columns[3].compressed_bytes == 0);
+            assert((sum_column<3, long>() == bool_sum));
+            gdb.add_vertex(count);
+            assert((sum_column<2, long>() == char_sum));
+            std::cout << "compression: " << before.total() << " -> " << after.total() << " bytes\n";
+        }
+    };
+
+    class test_compact_adjacency {
+        struct gs {
+            using vertex_user_id_t = int;
+            using vertex_property_t = std::tuple<int>;
+
+            using edge_user_id_t = int;
+            using edge_property_t = std::tuple<int>;
+        };
+        using gdb_t = graph_db<gs>;
+        gdb_t gdb;
+
+        std::vector<std::pair<int, int>> collect() {
+            std::vector<std::pair<int, int>> result;
+            auto[vertexes_begin, vertexes_end] = gdb.get_vertexes();
+            std::for_each(vertexes_begin, vertexes_end, [&result](auto &&vertex) {
+                auto[neigbor_edges_begin, neighbor_edges_end] = vertex.edges();
+                std::for_each(neigbor_edges_begin, neighbor_edges_end, [&result, &vertex](auto &&edge) {
+                    assert(edge.src().id() == vertex.id());
+                    result.emplace_back(edge.id(), edge.dst().id());
+                });
+            });
+            return result;
+        }
+
+    public:
+        void run() {
+            std::vector<gdb_t::vertex_t> vs;
+            for (int i = 0; i < 100; ++i)
+                vs.push_back(gdb.add_vertex(i, i));
+            int euid = 0;
+            for (int i = 0; i < 100; ++i)
+                for (int j = 0; j < i % 7; ++j)
+                    gdb.add_edge(euid++, vs[(i * 13 + j * 31) % 100], vs[(i + j) % 100], j);
+            gdb.add_edge(euid++, vs[5], vs[6]);
+
+            auto before = collect();
+            auto plain_bytes = gdb.memory_usage().neighbours.total();
+            gdb.compact_adjacency();
+            assert(gdb.is_compacted());
+            assert(collect() == before);
+            auto compact_bytes = gdb.memory_usage().neighbours.total();
+            assert(compact_bytes < plain_bytes);
+
+            gdb.add_edge(euid++, vs[5], vs[7]);
+            assert(!gdb.is_compacted());
+            auto after = collect();
+            assert(after.size() == before.size() + 1);
+            std::cout << "compact adjacency: " << plain_bytes << " -> " << compact_bytes << " bytes\n";
+        }
+    };
+
+    class test_triangles {
+        struct gs {
+            using vertex_user_id_t = int;
+            using vertex_property_t = std::tuple<int>;
+
+            using edge_user_id_t = int;
+            using edge_property_t = std::tuple<int>;
+        };
+        using gdb_t = graph_db<gs>;
+        gdb_t gdb;
+
+    public:
+        void run() {
+            //two squares sharing an edge, both with one diagonal -> 4 triangles
+            std::vector<gdb_t::vertex_t> vs;
+            for (int i = 0; i < 6; ++i)
+                vs.push_back(gdb.add_vertex(i));
+            int edges[][2] = { {0,1}, {1,2}, {2,3}, {3,0}, {0,2}, {1,4}, {4,5}, {5,2}, {1,5}, {2,1}, {3,3} };
+            int euid = 0;
+            for (auto &&e : edges)
+                gdb.add_edge(euid++, vs[e[1]], vs[e[0]]);
+
+            gdb.sort_adjacency();
+            assert(gdb.is_adjacency_sorted());
+            auto[neigbor_edges_begin, neighbor_edges_end] = vs[2].edges();
+            int last = -1;
+            std::for_each(neigbor_edges_begin, neighbor_edges_end, [&last](auto &&edge) {
+                assert(edge.dst().id() >= last);
+                last = edge.dst().id();
+            });
+
+            neighbour_index<gs> index(gdb);
+            assert(index.count_triangles(1) == 4);
+            assert(index.count_triangles(3) == 4);
+            assert(index.common_neighbours(vs[0], vs[2]) == 2);
+            assert(index.jaccard(vs[3], vs[1]) == 0.5);
+
+            std::size_t big[] = { 1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31, 33, 35, 37, 39, 41, 43, 45, 47, 49, 51, 53, 55, 57, 59, 61, 63, 65 };
+            std::size_t small[] = { 3, 4, 63 };
+            assert(intersect_gallop(small, 3, big, 33) == 2);
+            assert(intersect_merge(small, 3, big, 33) == 2);
+            std::cout << "triangles: " << index.count_triangles() << "\n";
+        }
+    };
+
+    class test_subgraph {
+        struct gs {
+            using vertex_user_id_t = int;
+            using vertex_property_t = std::tuple<int, std::string>;
+
+            using edge_user_id_t = int;
+            using edge_property_t = std::tuple<double>;
+        };
+        using gdb_t = graph_db<gs>;
+        gdb_t gdb;
+
+    public:
+        void run() {
+            std::vector<gdb_t::vertex_t> vs;
+            for (int i = 0; i < 200; ++i)
+                vs.push_back(gdb.add_vertex(i, i, "v"));
+            int euid = 0;
+            for (int i = 0; i < 200; ++i)
+                for (int j = 1; j <= 3; ++j)
+                    gdb.add_edge(euid++, vs[i], vs[(i + j * 7) % 200], j * 1.0);
+
+            subgraph_view<gs> view(gdb);
+            view.select_where<0>([](int p) { return p >= 10 && p < 150; });
+            view.mask_unless<0>([](double w) { return w < 3.0; });
+            assert(view.vertex_count() == 140);
+            assert(!view.contains(vs[5]) && view.contains(vs[10]));
+
+            std::size_t vertex_count = 0, edge_count = 0;
+            auto[vertexes_begin, vertexes_end] = view.get_vertexes();
+            std::for_each(vertexes_begin, vertexes_end, [&](auto &&vertex) {
+                ++vertex_count;
+                int p = vertex.template get_property<0>();
+                assert(p >= 10 && p < 150);
+                auto[neigbor_edges_begin, neighbor_edges_end] = view.edges(vertex);
+                std::for_each(neigbor_edges_begin, neighbor_edges_end, [&](auto &&edge) {
+                    ++edge_count;
+                    assert(view.contains(edge.dst()) && edge.template get_property<0>() < 3.0);
+                });
+            });
+            assert(vertex_count == 140);
+
+            auto csr = view.materialize();
+            assert(csr.vertex_count() == 140 && csr.edge_count() == edge_count);
+            for (std::size_t v = 0; v < csr.vertex_count(); ++v)
+                for (std::size_t k = csr.offsets[v]; k < csr.offsets[v + 1]; ++k)
+                    assert(view.edge_of(csr, k).dst().id() == view.vertex_of(csr, csr.targets[k]).id());
+            std::cout << "subgraph: " << csr.vertex_count() << " vertices, " << csr.edge_count() << " edges\n";
+
+            //vertices and edges added later are not part of the view and cannot be selected or masked
+            auto late = gdb.add_vertex(200, 200, "late");
+            auto late_edge = gdb.add_edge(euid++, late, vs[0], 1.0);
+            assert(!view.contains(late) && !view.contains(late_edge));
+            bool rejected = false;
+            try { view.select(late); } catch (const std::out_of_range &) { rejected = true; }
+            assert(rejected);
+            rejected = false;
+            try { view.mask(late_edge); } catch (const std::out_of_range &) { rejected = true; }
+            assert(rejected);
+            assert(view.vertex_count() == 140);
+        }
+    };
+
+    class test_snapshot {
+        struct gs {
+            using vertex_user_id_t = std::string;
+            using vertex_property_t = std::tuple<std::string, int, double, char>;
+
+            using edge_user_id_t = float;
+            using edge_property_t = std::tuple<std::string, bool>;
+        };
+        using gdb_t = graph_db<gs>;
+
+        template<typename DB>
+        static std::string dump(const DB &db) {
+            std::ostringstream out;
+            auto[vertexes_begin, vertexes_end] = db.get_vertexes();
+            std::for_each(vertexes_begin, vertexes_end, [&out](auto &&vertex) {
+                auto[p0, p1, p2, p3] = vertex.get_properties();
+                out << vertex.id() << ":" << p0 << "," << p1 << "," << p2 << "," << p3 << "\n";
+                auto[neigbor_edges_begin, neighbor_edges_end] = vertex.edges();
+                std::for_each(neigbor_edges_begin, neighbor_edges_end, [&out](auto &&edge) {
+                    out << " " << edge.id() << "->" << edge.dst().id() << ":" << std::get<0>(edge.get_properties())
+                        << "," << edge.template get_property<1>() << "\n";
+                });
+            });
+            return out.str();
+        }
+
+    public:
+        void run() {
+            gdb_t gdb;
+            std::vector<gdb_t::vertex_t> vs;
+            for (int i = 0; i < 300; ++i)
+                vs.push_back(gdb.add_vertex("v" + std::to_string(i), std::string(i % 40, 'a' + i % 26), i, i / 4.0, 'a' + i % 3));
+            for (int i = 0; i < 900; ++i)
+                gdb.add_edge(i * 0.5f, vs[i % 300], vs[(i * 7) % 300], "e" + std::to_string(i), i % 5 == 0);
+            gdb.compress_vertex_column<3>();
+
+            std::stringstream packed, plain;
+            snapshot<gs>::save(gdb, packed);
+            snapshot_options opt;
+            opt.compress = false;
+            opt.block_size = 1000;
+            snapshot<gs>::save(gdb, plain, opt);
+            assert(packed.str().size() < plain.str().size());
+
+            gdb_t copy, copy2;
+            snapshot<gs>::load(copy, packed);
+            snapshot<gs>::load(copy2, plain);
+            assert(dump(copy) == dump(gdb));
+            assert(dump(copy2) == dump(gdb));
+
+            std::string broken = packed.str();
+            broken[broken.size() / 2] ^= 0x5a;
+            std::istringstream broken_in(broken);
+            gdb_t copy3;
+            bool failed = false;
+            try {
+                snapshot<gs>::load(copy3, broken_in);
+            } catch (const std::runtime_error &) {
+                failed = true;
+            }
+            assert(failed);
+            auto[vertexes_begin, vertexes_end] = copy3.get_vertexes();
+            assert(!(vertexes_begin != vertexes_end));
+
+            //every single bit flip of a small snapshot either loads or raises std::runtime_error, never allocates a corrupted size
+            gdb_t small;
+            auto a = small.add_vertex("a", "x", 1, 0.5, 'a');
+            auto b = small.add_vertex("b", "yy", 2, 1.5, 'b');
+            small.add_edge(1.0f, a, b, "ab", true);
+            small.add_edge(2.0f, b, a, "ba", false);
+            small.add_vertex("c", "isolated", 3, 2.5, 'c');
+            std::stringstream small_out;
+            snapshot<gs>::save(small, small_out);
+            const std::string small_bytes = small_out.str();
+            std::size_t rejected = 0;
+            for (std::size_t bit = 0; bit < small_bytes.size() * 8; ++bit) {
+                std::string flipped = small_bytes;
+                flipped[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+                std::istringstream flipped_in(flipped);
+                gdb_t target;
+                try {
+                    snapshot<gs>::load(target, flipped_in);
+                } catch (const std::runtime_error &) {
+                    ++rejected;
+                }
+            }
+            assert(rejected > small_bytes.size() * 7);
+            //the counts of the header are not checksummed, dropping the isolated vertex leaves bytes of the sections unread
+            std::string fewer = small_bytes;
+            fewer[sizeof(std::uint64_t) + sizeof(std::uint32_t)] = 2;
+            std::istringstream fewer_in(fewer);
+            gdb_t copy5;
+            failed = false;
+            try {
+                snapshot<gs>::load(copy5, fewer_in);
+            } catch (const std::runtime_error &) {
+                failed = true;
+            }
+            assert(failed);
+            std::string wrong_id = small_bytes;
+            wrong_id[sizeof(std::uint64_t) + sizeof(std::uint32_t) + 2 * sizeof(std::uint64_t) + sizeof(std::uint32_t)] ^= 0x10; //first section id
+            std::istringstream wrong_id_in(wrong_id);
+            gdb_t copy4;
+            failed = false;
+            try {
+                snapshot<gs>::load(copy4, wrong_id_in);
+            } catch (const std::runtime_error &) {
+                failed = true;
+            }
+            assert(failed);
+            std::cout << "snapshot: " << plain.str().size() << " -> " << packed.str().size() << " bytes\n";
+        }
+    };
+
+    class test_pregel {
+        struct gs {
+            using vertex_user_id_t = int;
+            using vertex_property_t = std::tuple<int>;
+
+            using edge_user_id_t = int;
+            using edge_property_t = std::tuple<double>;
+        };
+        using gdb_t = graph_db<gs>;
+        gdb_t gdb;
+
+    public:
+        void run() {
+            //a weighted chain 0 -> 1 -> ... -> 49 with shortcuts 0 -> 10 and 10 -> 40, and an unreachable pair 50 <-> 51
+            std::vector<gdb_t::vertex_t> vs;
+            for (int i = 0; i < 52; ++i)
+                vs.push_back(gdb.add_vertex(i));
+            int euid = 0;
+            for (int i = 0; i + 1 < 50; ++i)
+                gdb.add_edge(euid++, vs[i], vs[i + 1], 1.0);
+            gdb.add_edge(euid++, vs[0], vs[10], 2.5);
+            gdb.add_edge(euid++, vs[10], vs[40], 100.0);
+            gdb.add_edge(euid++, vs[50], vs[51], 1.0);
+            gdb.add_edge(euid++, vs[51], vs[50], 1.0);
+
+            const double inf = 1e300;
+            for (std::size_t thrs : { 1, 4 }) {
+                pregel<gs, double, double> sssp(gdb, [&](const gdb_t::vertex_t &v) { return v.id() == 0 ? 0.0 : inf; }, thrs);
+                sssp.set_combiner([](double a, double b) { return std::min(a, b); });
+                sssp.run([](auto &ctx, const std::vector<double> &messages) {
+                    double best = ctx.state();
+                    for (double m : messages)
+                        best = std::min(best, m);
+                    if (best < ctx.state() || (ctx.superstep() == 0 && best < 1e300)) {
+                        ctx.state() = best;
+                        ctx.send_along_edges([best](const gdb_t::edge_t &e) { return best + e.get_property<0>(); });
+                    }
+                    ctx.vote_to_halt();
+                }, 1000);
+                assert(sssp.state(vs[10]) == 2.5 && sssp.state(vs[11]) == 3.5 && sssp.state(vs[49]) == 41.5);
+                assert(sssp.state(vs[51]) == inf);
+
+                //connected components by minimal label propagation without a combiner
+                pregel<gs, int, int> cc(gdb, [](const gdb_t::vertex_t &v) { return v.id(); }, thrs);
+                std::size_t steps = cc.run([](auto &ctx, const std::vector<int> &messages) {
+                    int label = ctx.state();
+                    for (int m : messages)
+                        label = std::min(label, m);
+                    if (label < ctx.state() || ctx.superstep() == 0) {
+                        ctx.state() = label;
+                        ctx.send_to_neighbours(label);
+                    }
+                    ctx.vote_to_halt();
+                }, 1000);
+                assert(cc.state(vs[49]) == 0 && cc.state(vs[51]) == 50);
+                assert(steps < 1000);
+            }
+            std::cout << "pregel: ok\n";
+        }
+    };
+
+    class test_inline_adjacency {
+        struct gs {
+            using vertex_user_id_t = int;
+            using vertex_property_t = std::tuple<int>;
+
+            using edge_user_id_t = int;
+            using edge_property_t = std::tuple<std::string, double, int>;
+        };
+        using gdb_t = graph_db<gs>;
+        gdb_t gdb;
+
+    public:
+        void run() {
+            std::vector<gdb_t::vertex_t> vs;
+            for (int i = 0; i < 50; ++i)
+                vs.push_back(gdb.add_vertex(i));
+            int euid = 0;
+            for (int i = 0; i < 50; ++i)
+                for (int j = 0; j < i % 4; ++j)
+                    gdb.add_edge(euid++, vs[i], vs[(i * 3 + j) % 50], "e", i + j * 0.5, j);
+            gdb.compact_adjacency();
+
+            inline_adjacency<gs, 1, 2> weighted(gdb);
+            for (auto &&v : vs) {
+                auto[neigbor_edges_begin, neighbor_edges_end] = v.edges();
+                auto entries = weighted.neighbours(v);
+                const auto *e = entries.first;
+                std::for_each(neigbor_edges_begin, neighbor_edges_end, [&weighted, &e](auto &&edge) {
+                    assert(e->template get<0>() == edge.template get_property<1>());
+                    assert(e->template get<1>() == edge.template get_property<2>());
+                    assert(weighted.dst(*e).id() == edge.dst().id() && weighted.edge(*e).id() == edge.id());
+                    ++e;
+                });
+                assert(e == entries.second);
+            }
+            std::cout << "inline adjacency: " << weighted.bytes() << " bytes\n";
+        }
+    };
+
+    class test_partition {
+        struct gs {
+            using vertex_user_id_t = int;
+            using vertex_property_t = std::tuple<std::string, int>;
+
+            using edge_user_id_t = int;
+            using edge_property_t = std::tuple<double>;
+        };
+        using gdb_t = graph_db<gs>;
+        using graph_t = sharded_graph<gs>;
+        gdb_t gdb;
+
+        static std::size_t run_processes(const graph_t &graph, shm_mailbox<int> &mailbox, int *results) {
+            //one forked process per shard, returns the number of processes which failed
+            std::size_t k = mailbox.shards(), failed = 0, started = 0;
+            for (std::size_t s = 0; s < k; ++s) {
+                pid_t pid = fork();
+                if (pid < 0) {
+                    //the shard never arrives, the started ones must not wait for it
+                    mailbox.abort();
+                    ++failed;
+                    continue;
+                }
+                ++started;
+                if (pid == 0) {
+                    try {
+                        auto labels = components(graph, s, nullptr, &mailbox);
+                        for (std::size_t v = 0; v < labels.size(); ++v)
+                            results[graph.global_id(s, v)] = labels[v];
+                    } catch (...) {
+                        mailbox.abort();
+                        _exit(1);
+                    }
+                    _exit(0);
+                }
+            }
+            //a process killed before it could abort (e.g. by a failed assert) must not leave the others waiting
+            for (std::size_t i = 0; i < started; ++i) {
+                int status = 0;
+                pid_t pid;
+                while ((pid = waitpid(-1, &status, 0)) < 0 && errno == EINTR)
+                    ;
+                if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                    mailbox.abort();
+                    ++failed;
+                }
+            }
+            return failed;
+        }
+
+        static std::vector<int> components(const graph_t &graph, std::size_t s, local_mailbox<int> *local, shm_mailbox<int> *shared) {
+            //minimal label propagation along forward edges, returns labels of owned vertices
+            std::vector<int> labels;
+            for (std::size_t v = 0; v < graph.owned_count(s); ++v)
+                labels.push_back(static_cast<int>(graph.global_id(s, v)));
+            auto program = [&labels](auto &ctx, std::size_t v, const std::vector<int> &messages) {
+                int label = labels[v];
+                for (int m : messages)
+                    label = std::min(label, m);
+                if (label < labels[v] || ctx.superstep() == 0) {
+                    labels[v] = label;
+                    ctx.send_to_neighbours(v, label);
+                }
+            };
+            if (local)
+                run_shard<gs, int>(graph, s, *local, program, 1000);
+            else
+                run_shard<gs, int>(graph, s, *shared, program, 1000);
+            return labels;
+        }
+
+    public:
+        void run() {
+            //four clusters of 30 vertices (rings with chords, both directions), joined by a single edge between clusters 0 and 1
+            std::vector<gdb_t::vertex_t> vs;
+            for (int i = 0; i < 120; ++i)
+                vs.push_back(gdb.add_vertex(i, "v" + std::to_string(i), i * 2));
+            int euid = 0;
+            for (int c = 0; c < 4; ++c)
+                for (int i = 0; i < 30; ++i)
+                    for (int d : { 1, 7 }) {
+                        gdb.add_edge(euid++, vs[c * 30 + i], vs[c * 30 + (i + d) % 30], 1.0);
+                        gdb.add_edge(euid++, vs[c * 30 + (i + d) % 30], vs[c * 30 + i], 1.0);
+                    }
+            gdb.add_edge(euid++, vs[5], vs[35], 2.0);
+
+            const std::size_t k = 4;
+            auto hashed = partitioner<gs>::hash(gdb, k);
+            auto greedy = partitioner<gs>::ldg(gdb, k);
+            auto hq = partitioner<gs>::quality(gdb, hashed, k), gq = partitioner<gs>::quality(gdb, greedy, k);
+            assert(gq.cut_edges < hq.cut_edges && gq.balance <= 1.1);
+
+            graph_t graph(gdb, greedy, k);
+            std::size_t owned = 0, edges = 0;
+            for (std::size_t s = 0; s < k; ++s) {
+                owned += graph.owned_count(s);
+                auto[edges_begin, edges_end] = graph.shard(s).get_edges();
+                std::for_each(edges_begin, edges_end, [&edges](auto &&) { ++edges; });
+                for (std::size_t v = 0; v < graph.owned_count(s) + graph.ghost_count(s); ++v) {
+                    //ghosts copy the properties, and their home is the owned copy of the same vertex
+                    auto home = graph.home(s, v);
+                    assert(!graph.is_ghost(home.shard, home.local) && graph.global_id(home.shard, home.local) == graph.global_id(s, v));
+                    assert(std::get<1>(vs[graph.global_id(s, v)].get_properties()) == static_cast<int>(graph.global_id(s, v)) * 2);
+                }
+            }
+            assert(owned == vs.size() && edges == static_cast<std::size_t>(euid));
+            assert(graph.locate(vs[35]).shard == greedy[35]);
+
+            //one thread per shard with in-process queues
+            std::vector<int> expected(vs.size());
+            for (std::size_t v = 0; v < vs.size(); ++v)
+                expected[v] = v < 60 ? 0 : v < 90 ? 60 : 90;
+            {
+                local_mailbox<int> mailbox(k);
+                std::vector<std::vector<int>> labels(k);
+                std::vector<std::thread> threads;
+                for (std::size_t s = 0; s < k; ++s)
+                    threads.emplace_back([&, s] { labels[s] = components(graph, s, &mailbox, nullptr); });
+                for (auto &&t : threads)
+                    t.join();
+                for (std::size_t s = 0; s < k; ++s)
+                    for (std::size_t v = 0; v < graph.owned_count(s); ++v)
+                        assert(labels[s][v] == expected[graph.global_id(s, v)]);
+            }
+
+            //one forked process per shard with shared memory queues, results come back through a shared array
+            {
+                shm_mailbox<int> mailbox(k, 4096);
+                void *mem = mmap(nullptr, vs.size() * sizeof(int), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+                assert(mem != MAP_FAILED);
+                int *results = static_cast<int *>(mem);
+                assert(run_processes(graph, mailbox, results) == 0);
+                assert(std::equal(expected.begin(), expected.end(), results));
+
+                //an overflowing box aborts the mailbox, so no shard waits forever for the failed one
+                shm_mailbox<int> tiny(k, 1);
+                assert(run_processes(graph, tiny, results) == k);
+                assert(tiny.aborted());
+                munmap(mem, vs.size() * sizeof(int));
+            }
+            std::cout << "partition: cut " << hq.cut_edges << " (hash) -> " << gq.cut_edges << " (ldg) of " << gq.total_edges << " edges\n";
+        }
+    };
+
+    class test_batch {
+        struct gs {
+            using vertex_user_id_t = int;
+            using vertex_property_t = std::tuple<std::string, int, bool, char>;
+
+            using edge_user_id_t = int;
+            using edge_property_t = std::tuple<double, bool>;
+        };
+        using gdb_t = graph_db<gs>;
+        gdb_t gdb;
+
+    public:
+        void run() {
+            std::vector<gdb_t::vertex_t> vs;
+            for (int i = 0; i < 300; ++i)
+                vs.push_back(gdb.add_vertex(i * 10, "v" + std::to_string(i), i % 50, i % 3 == 0, static_cast<char>('a' + i % 4)));
+            int euid = 0;
+            for (int i = 0; i < 300; ++i)
+                for (int j = 1; j <= i % 3; ++j)
+                    gdb.add_edge(euid++, vs[i], vs[(i + j * 7) % 300], i * 0.5, j == 1);
+
+            {
+                //plain collumns are viewed in place
+                auto batch = gdb.get_vertex_batch<0, 3>();
+                assert(batch.size() == vs.size() && batch.ids()[7] == 70);
+                assert(batch.column<0>().data() == &vs[0].get_property<0>());
+                assert(batch.column<1>()[5] == 'b');
+            }
+
+            gdb.compress_vertex_column<1>();
+            auto batch = gdb.get_vertex_batch<1, 2>();
+            assert(gdb.memory_usage().vertex_columns[1].compressed_bytes > 0);
+            long sum = 0;
+            for (int value : batch.column<0>())
+                sum += value;
+            assert(sum == 6 * (49 * 50 / 2));
+            assert(std::count(batch.column<1>().begin(), batch.column<1>().end(), 1) == 100);
+
+            auto selected = gdb.get_vertex_batch<1, 0>({ vs[42], vs[3] });
+            assert(selected.size() == 2 && selected.rows()[0] == 42 && selected.ids()[1] == 30);
+            assert(selected.column<0>()[0] == 42 && selected.column<1>()[1] == "v3");
+            assert(gdb.memory_usage().vertex_columns[1].compressed_bytes > 0);
+
+            auto edges = gdb.get_edge_batch<0, 1>();
+            assert(edges.size() == static_cast<std::size_t>(euid));
+            for (std::size_t i = 0; i < edges.size(); ++i)
+                assert(edges.column<0>()[i] == batch.rows()[edges.sources()[i]] * 0.5);
+
+            auto out = gdb.get_edge_batch<1>(vs[2]);
+            assert(out.size() == 2 && out.column<0>()[0] == 1 && out.column<0>()[1] == 0);
+            assert(out.targets()[0] == 9 && out.targets()[1] == 16);
+            std::cout << "batch: ok\n";
+        }
+    };
+
+    class test_aggregate {
+        struct gs {
+            using vertex_user_id_t = int;
+            using vertex_property_t = std::tuple<char, double, int, long>;
+
+            using edge_user_id_t = int;
+            using edge_property_t = std::tuple<int>;
+        };
+        using gdb_t = graph_db<gs>;
+        gdb_t gdb;
+
+    public:
+        void run() {
+            //enough rows for every thread to get its own chunk
+            for (int i = 0; i < 70000; ++i)
+                gdb.add_vertex(i, static_cast<char>('a' + i % 5), (i % 1000) / 8.0, 100 + i % 37, (i % 11) * 1000000007L);
+
+            std::map<char, std::pair<double, int>> expected;
+            auto[vertexes_begin, vertexes_end] = gdb.get_vertexes();
+            std::for_each(vertexes_begin, vertexes_end, [&expected](auto &&v) {
+                auto &e = expected[v.template get_property<0>()];
+                e.first += v.template get_property<1>();
+                ++e.second;
+            });
+
+            for (std::size_t thrs : { 1, 4 }) {
+                auto total = aggregate_vertices<1>(gdb, thrs);
+                assert(total.count == 70000 && total.min == 0 && total.max == 999 / 8.0);
+
+                auto groups = group_vertices_by<0, 1>(gdb, thrs);
+                assert(groups.size() == expected.size());
+                for (auto &&g : groups) {
+                    auto &e = expected[g.first];
+                    assert(g.second.count == static_cast<std::size_t>(e.second) && std::abs(g.second.mean() - e.first / e.second) < 1e-9);
+                }
+
+                //small range of int keys goes through a direct array, a wide range of long keys through hash tables
+                auto by_int = group_vertices_by<2, 0>(gdb, thrs);
+                assert(by_int.size() == 37 && by_int.front().first == 100 && by_int.back().first == 136);
+                auto by_long = group_vertices_by<3, 2>(gdb, thrs);
+                assert(by_long.size() == 11 && by_long[1].first == 1000000007L && by_long[1].second.min == 100);
+            }
+
+            //keys near the int64 limit would overflow a sum, only their bounds decide the direct array
+            std::vector<std::int64_t> big_keys(70000);
+            std::vector<int> ones(big_keys.size(), 1);
+            for (std::size_t i = 0; i < big_keys.size(); ++i)
+                big_keys[i] = std::numeric_limits<std::int64_t>::max() - static_cast<std::int64_t>(i % 3);
+            auto by_big = group_by(column_view<std::int64_t>(big_keys.data(), big_keys.size()), column_view<int>(ones.data(), ones.size()), 4);
+            assert(by_big.size() == 3 && by_big.back().first == std::numeric_limits<std::int64_t>::max());
+            assert(by_big.front().second.count + by_big[1].second.count + by_big.back().second.count == big_keys.size());
+            std::cout << "aggregate: ok\n";
+        }
+    };
+
+    class test_temporal {
+        struct gs {
+            using vertex_user_id_t = int;
+            using vertex_property_t = std::tuple<int>;
+
+            using edge_user_id_t = int;
+            using edge_property_t = std::tuple<std::string, long>;
+            static constexpr std::size_t edge_timestamp_index = 1;
+        };
+        using gdb_t = graph_db<gs>;
+        gdb_t gdb;
+
+        static std::vector<int> window(const gdb_t::vertex_t &v, long t0, long t1) {
+            std::vector<int> ids;
+            auto[begin, end] = v.edges_between(t0, t1);
+            std::for_each(begin, end, [&ids](auto &&e) { ids.push_back(e.id()); });
+            return ids;
+        }
+
+    public:
+        void run() {
+            std::vector<gdb_t::vertex_t> vs;
+            for (int i = 0; i < 4; ++i)
+                vs.push_back(gdb.add_vertex(i));
+            //edge i of vertex 0 has timestamp 10 * i, inserted out of order
+            for (int i : { 3, 1, 4, 0, 2, 5 })
+                gdb.add_edge(i, vs[0], vs[1 + i % 3], "e", 10L * i);
+            gdb.add_edge(100, vs[1], vs[2], "in order", 5L);
+            gdb.add_edge(101, vs[1], vs[3], "in order", 7L);
+
+            assert((window(vs[0], 10, 30) == std::vector<int>{ 1, 2, 3 }));
+            assert((window(vs[0], 11, 29) == std::vector<int>{ 2 }));
+            assert(window(vs[0], 60, 70).empty() && window(vs[0], 30, 20).empty());
+            assert((window(vs[1], 0, 100) == std::vector<int>{ 100, 101 }));
+
+            //edges appended in time order keep the whole list sorted, with properties or set afterwards
+            for (int i = 1; i <= 5; ++i) {
+                gdb.add_edge(200 + i, vs[2], vs[3], "in order", 10L * i);
+                assert(gdb.time_sorted_edges(vs[2]) == static_cast<std::size_t>(i));
+            }
+            for (int i = 6; i <= 8; ++i) {
+                auto e = gdb.add_edge(200 + i, vs[2], vs[3]);
+                e.set_property<1>(10L * i);
+                assert(gdb.time_sorted_edges(vs[2]) == static_cast<std::size_t>(i));
+            }
+            gdb.add_edge(209, vs[2], vs[3], "late", 15L);
+            assert(gdb.time_sorted_edges(vs[2]) == 8);
+            assert((window(vs[2], 15, 30) == std::vector<int>{ 209, 202, 203 }));
+            assert(gdb.time_sorted_edges(vs[2]) == 9);
+
+            //moving a timestamp reorders the list on the next query
+            auto[begin, end] = vs[0].edges_between(20L, 20L);
+            (*begin).set_property<1>(55L);
+            assert((window(vs[0], 40, 60) == std::vector<int>{ 4, 5, 2 }));
+
+            for (int i : { 3, 1, 2 })
+                gdb.add_edge(300 + i, vs[3], vs[0], "unsorted", 10L * i);
+            gdb.compact_adjacency();
+            //compaction sorts the lists by time
+            assert(gdb.time_sorted_edges(vs[3]) == 3);
+            assert((window(vs[3], 0, 100) == std::vector<int>{ 301, 302, 303 }));
+            assert((window(vs[0], 0, 39) == std::vector<int>{ 0, 1, 3 }));
+            //windows starting inside a compacted list, the second one with an edge id smaller than the one before
+            assert((window(vs[0], 20, 40) == std::vector<int>{ 3, 4 }));
+            assert((window(vs[2], 15, 30) == std::vector<int>{ 209, 202, 203 }));
+            assert((window(vs[2], 20, 30) == std::vector<int>{ 202, 203 }));
+            //a timestamp moved after compaction, the list is sorted into a copy and stays compacted
+            auto[late, late_end] = vs[2].edges_between(80L, 80L);
+            (*late).set_property<1>(12L);
+            assert((window(vs[2], 10, 15) == std::vector<int>{ 201, 208, 209 }));
+            assert(gdb.time_sorted_edges(vs[2]) == 0);
+            assert(gdb.is_compacted());
+
+            gdb.enable_sketches();
+            assert(gdb.degree_quantile(0) == 2 && gdb.estimate_in_degree(vs[2]) >= 3);
+            assert(gdb.evict_edges_before(10L) == 3);
+            //the sketches forget the evicted edges
+            assert(gdb.degree_quantile(0) == 0 && gdb.degree_quantile(0.34) == 3);
+            assert(gdb.estimate_distinct_neighbours(vs[1]) == 0 && gdb.estimate_in_degree(vs[2]) < 3);
+            assert(gdb.is_compacted());
+            assert((window(vs[0], 0, 100) == std::vector<int>{ 1, 3, 4, 5, 2 }));
+            assert(window(vs[1], 0, 100).empty());
+            auto[edges_begin, edges_end] = gdb.get_edges();
+            std::for_each(edges_begin, edges_end, [](auto &&e) { assert(e.template get_property<1>() >= 10); });
+            std::cout << "temporal: ok\n";
+        }
+    };
+
+    class test_pipeline {
+        struct gs {
+            using vertex_user_id_t = int;
+            using vertex_property_t = std::tuple<std::string, int>;
+
+            using edge_user_id_t = int;
+            using edge_property_t = std::tuple<double, int>;
+        };
+        using gdb_t = graph_db<gs>;
+        gdb_t gdb;
+
+    public:
+        void run() {
+            using namespace traversal;
+            std::vector<gdb_t::vertex_t> vs;
+            for (int i = 0; i < 40; ++i)
+                vs.push_back(gdb.add_vertex(i, "v" + std::to_string(i), i));
+            int euid = 0;
+            for (int i = 0; i < 40; ++i)
+                for (int j = 1; j <= 3; ++j)
+                    gdb.add_edge(euid++, vs[i], vs[(i + j) % 40], i * 0.5, j);
+
+            //the same query written as nested loops
+            std::vector<double> expected;
+            auto[vertexes_begin, vertexes_end] = gdb.get_vertexes();
+            std::for_each(vertexes_begin, vertexes_end, [&expected](auto &&v) {
+                if (v.template get_property<1>() > 10) {
+                    auto[neigbor_edges_begin, neighbor_edges_end] = v.edges();
+                    std::for_each(neigbor_edges_begin, neighbor_edges_end, [&expected](auto &&e) {
+                        expected.push_back(e.template get_property<0>());
+                    });
+                }
+            });
+            auto weights = gdb.vertices() | where<1>(gt(10)) | expand() | select<0>();
+            assert(weights.to_vector() == expected);
+            assert(weights.count() == 29 * 3 && weights.sum() == std::accumulate(expected.begin(), expected.end(), 0.0));
+
+            auto names = gdb.vertices() | where<1>(lt(5)) | expand() | where<1>(eq(2)) | destinations() | select<0>() | take(3);
+            assert((names.to_vector() == std::vector<std::string>{ "v2", "v3", "v4" }));
+            assert((gdb.edges() | filter([](const gdb_t::edge_t &e) { return e.dst().id() == 0; }) | transform([](const gdb_t::edge_t &e) { return e.src().id(); })).sum() == 37 + 38 + 39);
+
+            //the iterators now work with the standard library
+            auto[edges_begin, edges_end] = gdb.get_edges();
+            assert(std::distance(edges_begin, edges_end) == euid);
+            auto it = vertexes_begin;
+            assert((*it++).id() == 0 && (*it).id() == 1 && (*++it).id() == 2 && !(it == vertexes_begin));
+            std::cout << "pipeline: ok\n";
+        }
+    };
+
+    class test_layout {
+        struct gs {
+            using vertex_user_id_t = int;
+            using vertex_property_t = std::tuple<double, std::string, int, bool>;
+            using vertex_property_groups = property_groups<std::index_sequence<0, 1, 3>>;
+
+            using edge_user_id_t = int;
+            using edge_property_t = std::tuple<int, double>;
+            using edge_property_groups = property_groups<std::index_sequence<1, 0>>;
+        };
+        using gdb_t = graph_db<gs>;
+        gdb_t gdb;
+
+    public:
+        void run() {
+            static_assert(gs::vertex_property_groups::group_of<3>() == 0 && gs::vertex_property_groups::position_of<3>() == 2, "wrong group");
+            static_assert(gs::vertex_property_groups::group_of<2>() == gs::vertex_property_groups::npos, "2 is a plain collumn");
+
+            std::vector<gdb_t::vertex_t> vs;
+            for (int i = 0; i < 600; ++i)
+                vs.push_back(gdb.add_vertex(i, i * 0.25, "v" + std::to_string(i), i % 7, i % 2 == 0));
+            for (int i = 0; i < 600; ++i)
+                gdb.add_edge(i, vs[i], vs[(i + 1) % 600], i, i * 2.0);
+
+            //grouped properties of one row are adjacent, the plain one stays columnar
+            assert(reinterpret_cast<const char *>(&vs[1].get_property<0>()) - reinterpret_cast<const char *>(&vs[0].get_property<0>()) > static_cast<long>(sizeof(double)));
+            assert(&vs[0].get_property<2>() + 1 == &vs[1].get_property<2>());
+            vs[5].set_property<1>(std::string("five"));
+            vs[5].set_property<3>(true);
+            assert((vs[5].get_properties() == std::make_tuple(1.25, std::string("five"), 5, true)));
+
+            gdb.compress_vertex_column<2>();
+            long sum = 0;
+            gdb.scan_vertex_column<0>([&sum](const double *values, std::size_t n, std::size_t) {
+                for (std::size_t i = 0; i < n; ++i)
+                    sum += static_cast<long>(values[i] * 4);
+            });
+            assert(sum == 599 * 600 / 2);
+            auto batch = gdb.get_vertex_batch<3, 2>();
+            assert(std::count(batch.column<0>().begin(), batch.column<0>().end(), 1) == 301);
+            assert(aggregate_edges<1>(gdb).sum == 599 * 600);
+            assert(gdb.memory_usage().vertex_columns[0].heap_bytes == 0 && gdb.memory_usage().vertex_columns[1].capacity_bytes == 0);
+
+            std::stringstream bytes;
+            snapshot<gs>::save(gdb, bytes);
+            gdb_t copy;
+            snapshot<gs>::load(copy, bytes);
+            auto[vertexes_begin, vertexes_end] = copy.get_vertexes();
+            std::size_t i = 0;
+            std::for_each(vertexes_begin, vertexes_end, [&](auto &&v) { assert(v.get_properties() == vs[i++].get_properties()); });
+            auto[edges_begin, edges_end] = copy.get_edges();
+            std::for_each(edges_begin, edges_end, [](auto &&e) { assert(e.template get_property<1>() == e.template get_property<0>() * 2.0); });
+            std::cout << "layout: ok\n";
+        }
+    };
+
+    class test_sketches {
+        struct gs {
+            using vertex_user_id_t = int;
+            using vertex_property_t = std::tuple<int>;
+
+            using edge_user_id_t = int;
+            using edge_property_t = std::tuple<int>;
+        };
+        using gdb_t = graph_db<gs>;
+        gdb_t gdb;
+
+    public:
+        void run() {
+            const int n = 2000;
+            std::vector<gdb_t::vertex_t> vs;
+            for (int i = 0; i < n; ++i)
+                vs.push_back(gdb.add_vertex(i, i));
+            int euid = 0;
+            for (int i = 1; i < n; ++i)
+                gdb.add_edge(euid++, vs[i], vs[0]);
+            assert(!gdb.sketches() && gdb.estimate_in_degree(vs[0]) == 0);
+            //edges added before are replayed
+            gdb.enable_sketches();
+            for (int i = 1; i < n; ++i) {
+                gdb.add_edge(euid++, vs[0], vs[i]);
+                gdb.add_edge(euid++, vs[i], vs[(i * 7) % n]);
+                gdb.add_edge(euid++, vs[i], vs[(i + 1) % n]);
+                gdb.add_edge(euid++, vs[i], vs[(i + 1) % n]);
+            }
+
+            assert(std::abs(gdb.estimate_distinct_neighbours(vs[1]) - 3) < 0.5);
+            assert(std::abs(gdb.estimate_distinct_neighbours(vs[0]) - (n - 1)) < 0.2 * n);
+            assert(gdb.estimate_two_hop(vs[0]) > 0.8 * n);
+            assert(gdb.estimate_in_degree(vs[0]) >= static_cast<std::uint64_t>(n - 1));
+            auto heavy = gdb.heavy_vertices(0.1);
+            assert(heavy.size() == 1 && heavy[0].id() == 0);
+            assert(gdb.degree_quantile(0.5) == 4 && gdb.degree_quantile(1) == n - 1);
+            //vertices without edges count as degree zero
+            for (int i = n; i < 2 * n + 2; ++i)
+                vs.push_back(gdb.add_vertex(i, i));
+            assert(gdb.degree_quantile(0.5) == 0 && gdb.degree_quantile(0.51) == 4 && gdb.degree_quantile(1) == n - 1);
+
+            //sketches filled by two threads from halves of the edges equal the sketches of all edges
+            graph_sketches halves[2], all;
+            std::thread other([&halves] { for (std::size_t i = 0; i < 5000; ++i) halves[1].edge_added(i % 100, 5000 + i); });
+            for (std::size_t i = 5000; i < 10000; ++i)
+                halves[0].edge_added(i % 100, 5000 + i);
+            other.join();
+            for (std::size_t i = 0; i < 10000; ++i)
+                all.edge_added(i % 100, 5000 + i);
+            halves[0].merge(halves[1]);
+            assert(halves[0].distinct_neighbours(7) == all.distinct_neighbours(7));
+            assert(halves[0].in_degree(5007) == all.in_degree(5007));
+            for (double q : { 0.0, 0.01, 0.5, 0.999, 1.0 })
+                assert(halves[0].degree_quantile(q) == all.degree_quantile(q));
+
+            std::stringstream bytes;
+            snapshot<gs>::save(gdb, bytes);
+            gdb_t copy;
+            copy.enable_sketches();
+            snapshot<gs>::load(copy, bytes);
+            assert(copy.estimate_distinct_neighbours(copy.heavy_vertices(0.1)[0]) == gdb.estimate_distinct_neighbours(vs[0]));
+            std::cout << "sketches: ok\n";
+        }
+    };
+
     std::vector<std::function<void()>> tests;
 public:
     test_bench() {
         tests.push_back([](){ test_example t; t.run(); });
+        tests.push_back([](){ test_stats t; t.run(); });
+        tests.push_back([](){ test_compression t; t.run(); });
+        tests.push_back([](){ test_compact_adjacency t; t.run(); });
+        tests.push_back([](){ test_triangles t; t.run(); });
+        tests.push_back([](){ test_subgraph t; t.run(); });
+        tests.push_back([](){ test_snapshot t; t.run(); });
+        tests.push_back([](){ test_pregel t; t.run(); });
+        tests.push_back([](){ test_inline_adjacency t; t.run(); });
+        tests.push_back([](){ test_partition t; t.run(); });
+        tests.push_back([](){ test_batch t; t.run(); });
+        tests.push_back([](){ test_aggregate t; t.run(); });
+        tests.push_back([](){ test_temporal t; t.run(); });
+        tests.push_back([](){ test_pipeline t; t.run(); });
+        tests.push_back([](){ test_layout t; t.run(); });
+        tests.push_back([](){ test_sketches t; t.run(); });
     }
 
     void run_test(size_t i) const {
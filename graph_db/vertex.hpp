@@ -32,6 +32,7 @@ public:
      */
     auto get_properties() const{
         //return properties returned from function specified in collumns.hpp
+        db_->stats_.vertex_get_all();
         return db_->vertex_cols_.get_properties(internal_id_, std::make_index_sequence<std::tuple_size<typename GraphSchema::vertex_property_t>::value>{});
     }
 
@@ -40,14 +41,27 @@ public:
      * @brief Returns a single immutable property of the I-th element.
      * @tparam I An index of the property.
      * @return The value of the property.
-     * @note The first property is on index 0.
+     * @note The first property is on index 0. The value is returned by reference, so a compressed collumn is decompressed first.
+     * @see read_property
      */
     template<size_t I>
     decltype(auto) get_property() const{
         //return property returned from function specified in collumns.hpp
+        db_->stats_.template vertex_get<I>();
         return db_->vertex_cols_.template get_property<I>(internal_id_);
     }
 
+    /**
+     * @brief Returns a copy of a single property of the I-th element.
+     * @tparam I An index of the property.
+     * @note Unlike get_property it reads a compressed collumn in place, so concurrent readers can use it.
+     */
+    template<size_t I>
+    auto read_property() const{
+        db_->stats_.template vertex_get<I>();
+        return db_->vertex_cols_.template at<I>(internal_id_);
+    }
+
     /**
      * @brief Sets the values of properties of the element.
      * @tparam PropsType Types of the properties.
@@ -58,6 +72,7 @@ public:
     void set_properties(PropsType &&...props){
         //sets properties using function specified in collumns.hpp
         auto index_seq = std::make_index_sequence<std::tuple_size<typename GraphSchema::vertex_property_t>::value>{};
+        db_->stats_.vertex_set_all();
         return db_->vertex_cols_.assign_properties(internal_id_, index_seq, std::forward<PropsType>(props)...);    }
 
     /**
@@ -70,6 +85,7 @@ public:
     template<size_t I, typename PropType>
     void set_property(const PropType &prop){
         //sets property using function specified in collumns.hpp
+        db_->stats_.template vertex_set<I>();
         return db_->vertex_cols_.template assign_property<I>(internal_id_, prop);
     }
 
@@ -85,12 +101,32 @@ public:
      */
     std::pair<neighbor_it_t, neighbor_it_t> edges() const{
         //creates pair of neighbour iterators specified in iterators.hpp
+        if (db_->compacted_) {
+            const auto &adj = db_->adjacency_;
+            return std::make_pair(
+                neighbor_it_t(adj.data(), db_, adj.begin_of(internal_id_), adj.end_of(internal_id_)),
+                neighbor_it_t(adj.data(), db_, adj.end_of(internal_id_), adj.end_of(internal_id_))
+            );
+        }
         return std::make_pair(
             neighbor_it_t(&(db_->neighbours_[internal_id_]), db_, 0),
             neighbor_it_t(&(db_->neighbours_[internal_id_]), db_,db_->neighbours_[internal_id_].size())
         );
     }
 
+    /**
+     * @brief Returns begin() and end() iterators to the forward edges whose timestamp is in [t0, t1].
+     * @note Needs a schema with edge_timestamp_index. The list is binary searched, it is sorted by time on the first query after a change.
+     * On compacted adjacency (sorted by time in compact_adjacency) the window is found by decoding the list, a list
+     * whose timestamps changed afterwards is decoded into a sorted copy owned by the iterators, so the query only reads.
+     * On plain adjacency the method may reorder the list although it is const, so it must not run concurrently with any other access to the database.
+     * @see edge_timestamp
+     */
+    template<typename T>
+    std::pair<neighbor_it_t, neighbor_it_t> edges_between(const T &t0, const T &t1) const{
+        return db_->edges_between(internal_id_, t0, t1);
+    }
+
 private:
 
     friend class graph_db<GraphSchema>;
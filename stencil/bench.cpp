@@ -0,0 +1,280 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <functional>
+#include <utility>
+#include <thread>
+
+#include "stencil1d.hpp"
+#include "torus.hpp"
+
+/*
+Micro benchmarks of the stencil
+usage: Bench [name]   (runs all benchmarks without a name)
+*/
+
+template<typename F>
+double measure_ms(F &&f, int repeat = 3) {
+    //returns the best of repeated runs
+    double best = 0;
+    for (int r = 0; r < repeat; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (r == 0 || ms < best)
+            best = ms;
+    }
+    return best;
+}
+
+auto rule110_stencil = [](bool a1, bool a2, bool a3) {
+    auto idx = ((unsigned)a1 << 2) + ((unsigned)a2 << 1) + (unsigned)a3;
+    return bool((110 >> idx) & 1);
+};
+
+circle<bool> rule110_circle(std::size_t size) {
+    circle<bool> space(size);
+    space.set(size - 2, true);
+    return space;
+}
+
+void bench_barrier() {
+    //raw Wait() round trips and short rule110 blocks, mutex barrier vs spinning sense-reversing barrier
+    std::size_t thrs = std::max<std::size_t>(2, std::thread::hardware_concurrency());
+    const std::size_t rounds = 20000;
+    for (std::size_t spin : { std::size_t(0), std::size_t(4096) }) {
+        double ms = measure_ms([&] {
+            Barrier barrier(thrs, spin);
+            std::vector<std::thread> threads;
+            for (std::size_t t = 0; t < thrs; ++t)
+                threads.emplace_back([&barrier] { for (std::size_t r = 0; r < rounds; ++r) barrier.Wait(); });
+            for (auto &&t : threads)
+                t.join();
+        });
+        std::cout << (spin ? "spinning" : "mutex   ") << " barrier, " << thrs << " threads: " << ms * 1e6 / rounds << " ns/wait\n";
+    }
+    for (std::size_t spin : { std::size_t(0), std::size_t(4096) }) {
+        auto space = rule110_circle(4096);
+        space.set_barrier_spin(spin);
+        double ms = measure_ms([&] { space.run(rule110_stencil, 2000); });
+        std::cout << (spin ? "spinning" : "mutex   ") << " rule110 4096 cells x 2000 generations: " << ms << " ms\n";
+    }
+}
+
+void bench_sync() {
+    //ghost exchange between blocks: all holders at a barrier vs only the two neighbours
+    std::size_t thrs = std::max<std::size_t>(4, std::thread::hardware_concurrency());
+    for (bool neighbours : { false, true }) {
+        auto space = rule110_circle(1 << 16);
+        space.set_neighbour_sync(neighbours);
+        double ms = measure_ms([&] { space.run(rule110_stencil, 2000, thrs); });
+        std::cout << (neighbours ? "neighbour flags" : "global barrier ") << ", " << thrs << " threads, 65536 cells x 2000 generations: " << ms << " ms\n";
+    }
+}
+
+void bench_elementary() {
+    //rule110 on 27011 cells: per-cell lambda on vector<bool> vs elementary_rule on packed words
+    const std::size_t generations = 2000;
+    auto lambda_space = rule110_circle(27011), packed_space = rule110_circle(27011);
+    double lambda_ms = measure_ms([&] { lambda_space.run(rule110_stencil, generations); }, 1);
+    double packed_ms = measure_ms([&] { packed_space.run(elementary_rule{ 110 }, generations); }, 1);
+    bool same = true;
+    for (std::size_t i = 0; i < 27011; ++i)
+        same = same && lambda_space.get(i) == packed_space.get(i);
+    std::cout << "lambda:          " << lambda_ms << " ms\n";
+    std::cout << "elementary_rule: " << packed_ms << " ms" << (same ? "" : " MISMATCH") << "\n";
+}
+
+template <typename SF>
+void bench_table_of(const char *name, SF sf) {
+    const std::size_t size = 1 << 16, generations = 500;
+    circle<unsigned char> direct(size), tabled(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        direct.set(i, (i * 7919) % 8);
+        tabled.set(i, (i * 7919) % 8);
+    }
+    auto table = tabled.compile(sf);
+    double compile_ms = measure_ms([&] { tabled.compile(sf); }, 1);
+    double direct_ms = measure_ms([&] { direct.run(sf, generations); }, 1);
+    double table_ms = measure_ms([&] { tabled.run(table, generations); }, 1);
+    bool same = true;
+    for (std::size_t i = 0; i < size; ++i)
+        same = same && direct.get(i) == tabled.get(i);
+    std::cout << name << " stencil: " << direct_ms << " ms, table: " << table_ms << " ms (" << table.states() << " states, "
+              << table.bytes() << " B, compiled in " << compile_ms << " ms)" << (same ? "" : " MISMATCH") << "\n";
+}
+
+void bench_table() {
+    //the stencil called per cell vs its compiled lookup table, a cheap and a branchy 8-state automaton
+    bench_table_of("cyclic ", [](unsigned char a1, unsigned char a2, unsigned char a3) -> unsigned char {
+        unsigned char next = (a2 + 1) % 8;
+        return a1 == next || a3 == next ? next : a2;
+    });
+    bench_table_of("branchy", [](unsigned char a1, unsigned char a2, unsigned char a3) -> unsigned char {
+        switch (a2) {
+        case 0: return a1 > a3 ? a1 : a3 == 5 ? 1 : 0;
+        case 1: case 2: return a1 == a3 ? (a2 + a1) % 8 : a1 < 4 ? 3 : 6;
+        case 3: return a1 & 1 ? (a3 & 2 ? 7 : 2) : (a3 > 5 ? 4 : 0);
+        case 4: return a1 + a3 > 7 ? 5 : a1 == 0 ? 1 : 4;
+        default: return a3 < a1 ? (a1 ^ a3) % 8 : a2 == 7 ? 0 : a2 + 1;
+        }
+    });
+}
+
+void bench_tiling() {
+    //a block of many generations on a partition larger than L2: whole-buffer sweeps vs temporal tiles
+    auto sf = [](unsigned char a1, unsigned char a2, unsigned char a3) -> unsigned char { return (a1 + a3) ^ a2; };
+    const std::size_t size = 1 << 22, generations = 64;
+    for (std::size_t tile : { std::size_t(0), std::size_t(32 * 1024) }) {
+        circle<unsigned char> space(size);
+        for (std::size_t i = 0; i < size; ++i)
+            space.set(i, (i * 7919) % 11);
+        space.set_tile_bytes(tile);
+        double ms = measure_ms([&] { space.run(sf, generations, 1); }, 1);
+        std::cout << (tile ? "tiled: " : "sweep: ") << ms << " ms (" << int(space.get(12345)) << ")\n";
+    }
+}
+
+void bench_shrink() {
+    //the runs of R27011 and L10007 (one thread, ghost depth near half the partition) with and without shrinking ranges
+    auto cyclic_stencil = [](unsigned char a1, unsigned char a2, unsigned char a3) -> unsigned char {
+        unsigned char next = (a2 + 1) % 8;
+        return a1 == next || a3 == next ? next : a2;
+    };
+    for (bool shrink : { false, true }) {
+        auto rule = rule110_circle(27011);
+        rule.set_shrink(shrink);
+        double rule_ms = measure_ms([&] { rule.run(rule110_stencil, 13494, 1); }, 1);
+        circle<unsigned char> lem(10007);
+        for (std::size_t i = 0; i < 10007; ++i)
+            lem.set(i, (i * 7919) % 8);
+        lem.set_shrink(shrink);
+        double lem_ms = measure_ms([&] { lem.run(cyclic_stencil, 9973, 1); }, 1);
+        std::cout << (shrink ? "shrinking:   " : "whole buffer: ") << "rule110 27011 x 13494 " << rule_ms << " ms, 8-state 10007 x 9973 " << lem_ms << " ms\n";
+    }
+}
+
+void bench_autotune() {
+    //repeated runs of an 8-state stencil with the ghost width taken from the partition vs measured by the autotuner
+    auto cyclic_stencil = [](unsigned char a1, unsigned char a2, unsigned char a3) -> unsigned char {
+        unsigned char next = (a2 + 1) % 8;
+        return a1 == next || a3 == next ? next : a2;
+    };
+    std::size_t thrs = std::thread::hardware_concurrency();
+    for (bool tune : { false, true }) {
+        circle<unsigned char> space(10007);
+        for (std::size_t i = 0; i < 10007; ++i)
+            space.set(i, (i * 7919) % 8);
+        space.set_autotune(tune);
+        double first_ms = measure_ms([&] { space.run(cyclic_stencil, 9973, thrs); }, 1);
+        double ms = measure_ms([&] { space.run(cyclic_stencil, 9973, thrs); });
+        std::cout << (tune ? "autotuned:  " : "default:    ") << "10007 x 9973 first run " << first_ms << " ms, then " << ms << " ms";
+        if (tune)
+            std::cout << " (ghost " << space.tuned_ghost() << ", " << space.tuned_threads() << " threads)";
+        std::cout << "\n";
+    }
+}
+
+void bench_life() {
+    //Game of Life on a 1024x1024 torus: a plain double loop over two grids vs torus<bool, 2> on one and more threads
+    const std::size_t side = 1024, generations = 200;
+    auto life = [](bool alive, const std::array<bool, 8> &neighbours) {
+        int count = 0;
+        for (bool n : neighbours)
+            count += n;
+        return count == 3 || (alive && count == 2);
+    };
+    std::vector<unsigned char> cells(side * side);
+    for (std::size_t i = 0; i < cells.size(); ++i)
+        cells[i] = (i * 7919 + i / 13) % 3 == 0;
+
+    std::vector<unsigned char> plain = cells, next(cells.size());
+    double plain_ms = measure_ms([&] {
+        for (std::size_t gen = 0; gen < generations; ++gen) {
+            for (std::size_t y = 0; y < side; ++y)
+                for (std::size_t x = 0; x < side; ++x) {
+                    int count = 0;
+                    for (std::size_t dy : { side - 1, std::size_t(0), std::size_t(1) })
+                        for (std::size_t dx : { side - 1, std::size_t(0), std::size_t(1) })
+                            count += plain[(y + dy) % side * side + (x + dx) % side];
+                    bool alive = plain[y * side + x];
+                    count -= alive;
+                    next[y * side + x] = count == 3 || (alive && count == 2);
+                }
+            plain.swap(next);
+        }
+    }, 1);
+    std::cout << "plain loop:         " << plain_ms << " ms\n";
+
+    for (std::size_t thrs : { std::size_t(1), std::max<std::size_t>(4, std::thread::hardware_concurrency()) }) {
+        torus<bool, 2> space({ side, side });
+        for (std::size_t i = 0; i < cells.size(); ++i)
+            space.set({ std::ptrdiff_t(i / side), std::ptrdiff_t(i % side) }, cells[i]);
+        double ms = measure_ms([&] { space.run(life, generations, thrs); }, 1);
+        bool same = true;
+        for (std::size_t i = 0; i < cells.size(); ++i)
+            same = same && space.get({ std::ptrdiff_t(i / side), std::ptrdiff_t(i % side) }) == bool(plain[i]);
+        std::cout << "torus, " << thrs << " thread(s):  " << ms << " ms" << (same ? "" : " MISMATCH") << "\n";
+    }
+}
+
+template <std::size_t R>
+void bench_radius_of(std::size_t size, std::size_t generations) {
+    auto smooth = [](const std::array<float, 2 * R + 1> &cells) {
+        float sum = 0;
+        for (float c : cells)
+            sum += c;
+        return sum / cells.size();
+    };
+    std::vector<float> plain(size), next(size);
+    circle<float> space(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        plain[i] = float(i * 7919 % 1000);
+        space.set(i, plain[i]);
+    }
+    double plain_ms = measure_ms([&] {
+        for (std::size_t gen = 0; gen < generations; ++gen) {
+            for (std::size_t i = 0; i < size; ++i) {
+                float sum = 0;
+                for (std::size_t j = 0; j < 2 * R + 1; ++j)
+                    sum += plain[(i + size - R + j) % size];
+                next[i] = sum / (2 * R + 1);
+            }
+            plain.swap(next);
+        }
+    }, 1);
+    double ms = measure_ms([&] { space.run<R>(smooth, generations); }, 1);
+    bool same = true;
+    for (std::size_t i = 0; i < size; ++i)
+        same = same && space.get(i) == plain[i];
+    std::cout << "R=" << R << ": plain loop " << plain_ms << " ms, circle " << ms << " ms" << (same ? "" : " MISMATCH") << "\n";
+}
+
+void bench_radius() {
+    //box smoothing of 2R+1 cells on 2^18 floats x 200 generations, plain loop over two vectors vs circle::run<R>
+    bench_radius_of<2>(1 << 18, 200);
+    bench_radius_of<3>(1 << 18, 200);
+    bench_radius_of<4>(1 << 18, 200);
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<std::pair<std::string, std::function<void()>>> benches = {
+        { "barrier", bench_barrier },
+        { "sync", bench_sync },
+        { "elementary", bench_elementary },
+        { "table", bench_table },
+        { "tiling", bench_tiling },
+        { "shrink", bench_shrink },
+        { "autotune", bench_autotune },
+        { "life", bench_life },
+        { "radius", bench_radius },
+    };
+    for (auto &&b : benches) {
+        if (argc < 2 || b.first == argv[1]) {
+            std::cout << "== " << b.first << "\n";
+            b.second();
+        }
+    }
+    return 0;
+}
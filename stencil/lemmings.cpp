@@ -188,11 +188,7 @@ void rule110(std::size_t xs, std::size_t max_gen, std::size_t gpt, int lnw = 0,
 	
 	space.set(space.size() - 2, true);
 
-	auto rule110_stencil = [](bool a1, bool a2, bool a3) {
-		auto idx = ((unsigned)a1 << 2) + ((unsigned)a2 << 1) + (unsigned)a3;
-
-		return (110 >> idx) & 1;
-	};
+	elementary_rule rule110_stencil{ 110 };	// evaluated 64 cells at once by circle<bool>
 
 	auto rule110_print = [](bool a) { std::cout << (a ? '#' : '.'); };
 
@@ -255,12 +251,14 @@ void lemmings(std::size_t xs, std::size_t max_gen, std::size_t gpt, int lnw = 0,
 		std::cout << lem.print();
 	};
 
+	auto lemming_table = lemworld.compile( Lemming::stencil);	// a table of the reachable states
+
 	for (std::size_t g = 0; g < max_gen; ++g)
 	{
 		if (lnw || (last > 0 && g > max_gen - last))
 			print(lemworld, lemming_print, g, lnw, 0);
 		// dbg:		else if (g % 1000 == 0) std::cout << ".";
-		lemworld.run( Lemming::stencil, gpt);
+		lemworld.run( lemming_table, gpt);
 	}
 	print(lemworld, lemming_print, max_gen, lnw, 0);
 	std::cout << "----" << std::endl;
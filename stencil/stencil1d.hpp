@@ -4,6 +4,8 @@ Michal Půlpán
 new version
 */
 
+#pragma once
+
 #include <vector>
 #include <thread>
 #include <math.h>
@@ -12,24 +14,48 @@ new version
 #include <iostream>
 #include <mutex>
 #include <condition_variable>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <cstring>
+#include <array>
+#include <map>
+#include <tuple>
+#include <chrono>
 
 
 //forward declarations
 class Barrier;
+class ThreadPool;
 template<typename ET>
 class circle;
 template<typename ET>
 class holder;
 
+//with iSpin > 0 the barrier is sense-reversing: arrivals are counted atomically and waiters spin
+//up to iSpin times on the shared sense before sleeping, with iSpin == 0 every Wait takes the mutex
 class Barrier {
 public:
-    explicit Barrier(std::size_t iCount) : 
+    explicit Barrier(std::size_t iCount, std::size_t iSpin = 0) : 
       mThreshold(iCount), 
       mCount(iCount), 
-      mGeneration(0) {
+      mGeneration(0), 
+      mSpin(iSpin), 
+      mArrivals(iCount), 
+      mSense(false) {
     }
 
+    //must not be called while a thread waits
+    void SetSpin(std::size_t iSpin) { mSpin = iSpin; }
+
+    std::size_t Spin() const { return mSpin; }
+
     void Wait() {
+        if (mSpin) {
+            SpinWait();
+            return;
+        }
         std::unique_lock<std::mutex> lLock(mMutex);
         auto lGen = mGeneration;
         if (!--mCount) {
@@ -42,13 +68,203 @@ public:
     }
 
 private:
+    void SpinWait() {
+        //the sense cannot flip before this thread arrives, so the next phase waits for its negation
+        bool lSense = !mSense.load(std::memory_order_relaxed);
+        if (mArrivals.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            mArrivals.store(mThreshold, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lLock(mMutex);
+                mSense.store(lSense, std::memory_order_release);
+            }
+            mCond.notify_all();
+            return;
+        }
+        for (std::size_t i = 0; i < mSpin; i++)
+            if (mSense.load(std::memory_order_acquire) == lSense)
+                return;
+        std::unique_lock<std::mutex> lLock(mMutex);
+        mCond.wait(lLock, [this, lSense] { return mSense.load(std::memory_order_acquire) == lSense; });
+    }
+
     std::mutex mMutex;
     std::condition_variable mCond;
     std::size_t mThreshold;
     std::size_t mCount;
     std::size_t mGeneration;
+    std::size_t mSpin;
+    std::atomic<std::size_t> mArrivals;
+    std::atomic<bool> mSense;
 };
 
+//threads kept alive between circle::run calls, the calling thread works as worker 0
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t iCount) : 
+      mCount(iCount), 
+      mPending(0), 
+      mGeneration(0), 
+      mStop(false) {
+        for (std::size_t i = 1; i < mCount; i++)
+            mThreads.emplace_back(&ThreadPool::Work, this, i);
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lLock(mMutex);
+            mStop = true;
+        }
+        mStart.notify_all();
+        for (auto&& thread : mThreads)
+            thread.join();
+    }
+
+    std::size_t Size() const { return mCount; }
+
+    //calls iJob(i) for every worker i and returns when all of them are done
+    void Run(const std::function<void(std::size_t)>& iJob) {
+        {
+            std::lock_guard<std::mutex> lLock(mMutex);
+            mJob = &iJob;
+            mPending = mCount - 1;
+            mGeneration++;
+        }
+        mStart.notify_all();
+        iJob(0);
+        std::unique_lock<std::mutex> lLock(mMutex);
+        mDone.wait(lLock, [this] { return mPending == 0; });
+        mJob = nullptr;
+    }
+
+private:
+    void Work(std::size_t iId) {
+        std::size_t lGen = 0;
+        for (;;) {
+            const std::function<void(std::size_t)>* lJob;
+            {
+                std::unique_lock<std::mutex> lLock(mMutex);
+                mStart.wait(lLock, [this, lGen] { return mStop || lGen != mGeneration; });
+                if (mStop)
+                    return;
+                lGen = mGeneration;
+                lJob = mJob;
+            }
+            (*lJob)(iId);
+            std::lock_guard<std::mutex> lLock(mMutex);
+            if (!--mPending)
+                mDone.notify_one();
+        }
+    }
+
+    std::mutex mMutex;
+    std::condition_variable mStart;
+    std::condition_variable mDone;
+    std::vector<std::thread> mThreads;
+    const std::function<void(std::size_t)>* mJob = nullptr;
+    std::size_t mCount;
+    std::size_t mPending;
+    std::size_t mGeneration;
+    bool mStop;
+};
+
+
+//elementary cellular automaton rule (Wolfram numbering), usable as a stencil of any circle,
+//circle<bool>::run evaluates it on 64 cells at once with bitwise operations
+struct elementary_rule {
+    unsigned number;
+
+    bool operator()(bool a1, bool a2, bool a3) const { return (number >> (((unsigned)a1 << 2) | ((unsigned)a2 << 1) | (unsigned)a3)) & 1; }
+};
+
+//stencil over one-byte cells precomputed into a lookup table, made by circle::compile
+//the table covers the states reachable from the circle (about states^3 entries) or all 256^3 byte triples
+template<typename ET, typename SF>
+class table_stencil {
+public:
+    static_assert(sizeof(ET) == 1 && std::is_trivially_copyable<ET>::value && std::is_default_constructible<ET>::value,
+                  "table_stencil needs a trivially copyable one-byte cell type");
+
+    table_stencil(SF sf, std::vector<unsigned char> states) : sf_(std::move(sf)), tables_(std::make_shared<tables>()) {
+        tables_->index.fill(unknown);
+        states_ = states.size();
+        //state indexes are padded to a power of two so an entry is addressed by shifts
+        shift_ = 0;
+        while((std::size_t(1) << shift_) < states_)
+            shift_++;
+        for(std::size_t i=0; i<states_; i++)
+            tables_->index[states[i]] = i;
+        tables_->table.resize(std::size_t(1) << (3*shift_));
+        for(std::size_t i=0; i<states_; i++)
+            for(std::size_t j=0; j<states_; j++)
+                for(std::size_t k=0; k<states_; k++)
+                    tables_->table[(((i << shift_) | j) << shift_) | k] = toByte(sf_(fromByte(states[i]), fromByte(states[j]), fromByte(states[k])));
+        index_ = tables_->index.data();
+        table_ = tables_->table.data();
+    }
+
+    ET operator()(const ET& a1, const ET& a2, const ET& a3) const{
+        std::size_t i1 = index_[toByte(a1)], i2 = index_[toByte(a2)], i3 = index_[toByte(a3)];
+        //a state set into the circle after compile is not in the table
+        if((i1 | i2 | i3) & unknown)
+            return sf_(a1, a2, a3);
+        return fromByte(table_[(((i1 << shift_) | i2) << shift_) | i3]);
+    }
+
+    //out[i] = stencil(in[i], in[i+1], in[i+2]) for i < n, used by holder instead of calling the stencil per cell
+    void apply(const ET* in, ET* out, std::size_t n) const{
+        //members are copied to locals, stores of one-byte cells could alias them otherwise
+        const std::uint16_t* index = index_;
+        const unsigned char* table = table_;
+        std::size_t shift = shift_;
+        if(!n)
+            return;
+        std::size_t i1 = index[toByte(in[0])], i2 = index[toByte(in[1])];
+        for(std::size_t i=0; i<n; i++){
+            std::size_t i3 = index[toByte(in[i+2])];
+            out[i] = (i1 | i2 | i3) & unknown ? sf_(in[i], in[i+1], in[i+2]) : fromByte(table[(((i1 << shift) | i2) << shift) | i3]);
+            i1 = i2;
+            i2 = i3;
+        }
+    }
+
+    std::size_t states() const { return states_; }
+
+    std::size_t bytes() const { return tables_->table.size() + sizeof(tables_->index); }
+
+private:
+    static constexpr std::uint16_t unknown = 0x100;
+
+    static unsigned char toByte(const ET& v){
+        unsigned char b;
+        std::memcpy(&b, &v, 1);
+        return b;
+    }
+
+    static ET fromByte(unsigned char b){
+        ET v;
+        std::memcpy(&v, &b, 1);
+        return v;
+    }
+
+    //shared by the copies every holder makes
+    struct tables {
+        std::array<std::uint16_t, 256> index; //byte -> state index, unknown if not in the table
+        std::vector<unsigned char> table;
+    };
+
+    SF sf_;
+    std::shared_ptr<tables> tables_;
+    const std::uint16_t* index_;
+    const unsigned char* table_;
+    std::size_t states_;
+    std::size_t shift_; //bits of a state index
+};
+
+//detects stencils with a row kernel apply(const ET* in, ET* out, std::size_t n) (e.g. table_stencil)
+template<typename SF, typename ET, typename = void>
+struct has_row_kernel : std::false_type {};
+template<typename SF, typename ET>
+struct has_row_kernel<SF, ET, std::void_t<decltype(std::declval<const SF&>().apply(std::declval<const ET*>(), std::declval<ET*>(), std::size_t(0)))>> : std::true_type {};
 
 template<typename ET>
 class circle{
@@ -58,100 +274,261 @@ public:
         circle_ = std::vector<ET>(size_);
     }
 
+    //only cells are copied, holders and threads belong to a single circle
+    circle(const circle& other) : circle(other.size_) { circle_ = other.circle_; }
+
+    circle& operator=(const circle& other){
+        if(this != &other){
+            size_ = other.size_;
+            circle_ = other.circle_;
+            holders_.clear();
+            tuning_ = Tuning();
+        }
+        return *this;
+    }
+
     std::size_t size() const { return size_; }
 
+    //spins of a waiting thread in the barrier before it sleeps, 0 selects the mutex barrier
+    //spinning is used only while the threads fit the hardware threads
+    void set_barrier_spin(std::size_t spin) { spin_ = spin; }
+
+    //true: holders wait only for their two neighbours between blocks, false: for all holders at a barrier
+    void set_neighbour_sync(bool on) { neighbourSync_ = on; }
+
+    //bytes of both buffers of a temporal tile (a block of generations runs tile by tile), 0 sweeps whole buffers
+    void set_tile_bytes(std::size_t bytes) { tileBytes_ = bytes; }
+
+    //true: the k-th generation of a block computes only cells [k, size-k) of a holder, false: the whole buffer
+    void set_shrink(bool on) { shrink_ = on; }
+
     void set(std::ptrdiff_t x, const ET& v){ circle_[modulo(x, size_)] = v; }
 
     ET get(std::ptrdiff_t x) const{ return circle_[modulo(x, size_)]; }
 
+    //precomputes a pure stencil sf of one-byte cells into a table_stencil for run
+    //the table covers the closure of the states now in the circle under sf, when it has more than
+    //maxStates states the full table of all 256^3 byte triples (16 MiB) is built instead
     template<typename SF>
+    table_stencil<ET, std::decay_t<SF>> compile(SF&& sf, std::size_t maxStates = 64) const{
+        std::array<bool, 256> known{};
+        std::vector<unsigned char> states;
+        auto add = [&known, &states](const ET& v){
+            unsigned char b;
+            std::memcpy(&b, &v, 1);
+            if(!known[b]){
+                known[b] = true;
+                states.push_back(b);
+            }
+        };
+        for(auto&& cell : circle_)
+            add(cell);
+
+        //every round applies sf to all triples of known states until no new state appears
+        std::size_t closed = 0;
+        while(closed < states.size() && states.size() <= maxStates){
+            closed = states.size();
+            for(std::size_t i=0; i<closed && states.size() <= maxStates; i++)
+                for(std::size_t j=0; j<closed; j++)
+                    for(std::size_t k=0; k<closed; k++){
+                        ET a1, a2, a3;
+                        std::memcpy(&a1, &states[i], 1);
+                        std::memcpy(&a2, &states[j], 1);
+                        std::memcpy(&a3, &states[k], 1);
+                        add(sf(a1, a2, a3));
+                    }
+        }
+        if(states.size() > maxStates){
+            states.resize(256);
+            for(std::size_t b=0; b<256; b++)
+                states[b] = b;
+        }
+        return table_stencil<ET, std::decay_t<SF>>(std::forward<SF>(sf), std::move(states));
+    }
+
+    //R is the stencil radius: R == 1 calls sf(a1, a2, a3), R > 1 calls sf(cells) with the std::array<ET, 2R+1>
+    //of the cell and R neighbours on each side, the circle must have at least R cells
+    template<std::size_t R = 1, typename SF>
     void run(SF&& sf, std::size_t g, std::size_t thrs = std::thread::hardware_concurrency()){
+        static_assert(R > 0, "a stencil reads at least its direct neighbours");
+        if constexpr (R == 1 && std::is_same<ET, bool>::value && std::is_same<std::decay_t<SF>, elementary_rule>::value){
+            runPacked(sf.number, g);
+            return;
+        }
         //thrs = 4;
-        if (thrs > size_)
-		    thrs = size_;
+        //a holder copies its ghost cells (at least R) from the neighbours' own cells
+        if (thrs > std::max<std::size_t>(size_ / R, 1))
+		    thrs = std::max<std::size_t>(size_ / R, 1);
 
-        std::vector<std::size_t> partSizes(thrs);
-        std::size_t base, toAdd, myG;
-        Barrier barrier(thrs);
-
-        base = floor(this->size_/thrs);
-        toAdd = size_-(base*thrs);
-        for(std::size_t i = 0; i<thrs; i++)
-            partSizes[i] = base;
-        
-        while(toAdd > 0){
-            for(std::size_t i = 0; i<thrs; i++){
-                partSizes[i] += 1;
-                if(!--toAdd)
-                    break;
-            }
+        if(autotune_){
+            runTuned<R>(sf, g, thrs);
+            return;
         }
+        //a block of myG generations needs myG*R ghost cells on each side
+        std::size_t base = size_/thrs;
+        std::size_t myG = std::max(std::min((int)((base - 1) / (2 * R)), (int)g),1);
+        runBlocks<R>(sf, g, thrs, myG);
+    }
 
-        //myG = g;
-/*
-        if(myG>base/2)
-            myG = floor(base/2);
-  */
-        myG = std::max(std::min((int)((base - 1) / 2), (int)g),1);
-/*
-
-        if(myG < g){
-            std::size_t remainder = g % myG;
-            std::size_t blocks = ceil(g/myG);
+    //ghost width and thread count of the next runs are measured instead of taken from the partition size,
+    //run(sf, g, thrs) then tries thread counts up to thrs, the choice is shared by all circles of the same size
+    void set_autotune(bool on) { autotune_ = on; }
 
-            for(std::size_t i=0;i<blocks-1;i++)
-                blocks_.push_back(myG);
+    //ghost width (generations of a block, R ghost cells each) and thread count chosen by the autotuner, 0 while it is still measuring
+    std::size_t tuned_ghost() const { return tuning_.complete() ? tuning_.best().ghost : 0; }
+    std::size_t tuned_threads() const { return tuning_.complete() ? tuning_.best().thrs : 0; }
 
-            if(remainder == 0){
-                blocks_.push_back(myG);
-            } else {
-                blocks_.push_back(remainder);
-            }
-            
-        } else {
-            //no need for dividing into blocks
-            blocks_.push_back(myG);
-        }*/
+private:
+    template<std::size_t R, typename SF>
+    void runBlocks(SF&& sf, std::size_t g, std::size_t thrs, std::size_t myG){
+        std::size_t base = size_/thrs;
+        preparePool(thrs);
 
         std::size_t circleIndex = 0;
         std::size_t rem = size_ % thrs;
         for(std::size_t i = 0; i <thrs; i++){
-            
-            if(i<rem){
-
-                holders_.emplace_back(this, &barrier, i, base + 1, myG, circleIndex);
-                circleIndex += base +1;
+            std::size_t w = i<rem ? base + 1 : base;
+            if(holders_.size() <= i)
+                holders_.emplace_back(this, barrier_.get(), i, w, myG * R, R, circleIndex);
+            else
+                holders_[i].load(w, myG * R, R, circleIndex);
+            circleIndex += w;
+        }
 
-            } else {
-                holders_.emplace_back(this, &barrier, i, base, myG, circleIndex);
-                circleIndex += base;
+        std::function<void(std::size_t)> job = [this, &sf, g](std::size_t i){ holders_[i].template run<R>(sf, g); };
+        pool_->Run(job);
 
-            }
+        for(auto&& holder : holders_)
+            copyBackToCircle(holder);
+    }
 
-            //holders_.push_back(holder<ET>(this, &barrier, i, partSizes[i], myG, circleIndex));
-            //circleIndex += partSizes[i];
+    void preparePool(std::size_t thrs){
+        //threads, barrier and holders (with their buffers) are reused while the thread count stays the same
+        if(!pool_ || pool_->Size() != thrs){
+            holders_.clear();
+            pool_.reset();
+            pool_ = std::make_unique<ThreadPool>(thrs);
+            barrier_ = std::make_unique<Barrier>(thrs);
         }
+        barrier_->SetSpin(thrs <= std::thread::hardware_concurrency() ? spin_ : 0);
+    }
+
+    struct Candidate {
+        std::size_t thrs;
+        std::size_t ghost;
+        double nsPerGen; //negative until measured
+    };
 
-        for(std::size_t i = 0; i < holders_.size(); i++)
-            threads_.emplace_back(std::ref(holders_[i]), std::ref(sf), std::ref(g));
+    struct Tuning {
+        std::size_t size = 0;
+        std::size_t maxThreads = 0;
+        std::size_t radius = 0;
+        std::vector<Candidate> candidates;
+        std::size_t measured = 0;
 
-        for(auto&& thread: threads_){
-            if(thread.joinable())
-                thread.join();
+        bool complete() const { return !candidates.empty() && measured == candidates.size(); }
+
+        const Candidate& best() const{
+            return *std::min_element(candidates.begin(), candidates.end(), [](auto&& a, auto&& b){ return a.nsPerGen < b.nsPerGen; });
+        }
+    };
+
+    static constexpr std::size_t minTrialGens = 32;
+
+    template<std::size_t R, typename SF>
+    void runTuned(SF&& sf, std::size_t g, std::size_t thrs){
+        //every candidate runs a slice of the real generations (any ghost width gives the same cells), timed per generation
+        if(tuning_.size != size_ || tuning_.maxThreads != thrs || tuning_.radius != R)
+            tuning_ = cachedTuning(thrs, R);
+        while(g > 0 && !tuning_.complete()){
+            Candidate& c = tuning_.candidates[tuning_.measured];
+            std::size_t gens = std::min(g, std::max(2 * c.ghost, minTrialGens));
+            preparePool(c.thrs);
+            auto start = std::chrono::steady_clock::now();
+            runBlocks<R>(sf, gens, c.thrs, c.ghost);
+            c.nsPerGen = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / gens;
+            g -= gens;
+            if(++tuning_.measured == tuning_.candidates.size()){
+                std::lock_guard<std::mutex> lock(cacheMutex());
+                cache()[{ size_, thrs, R }] = tuning_;
+            }
         }
+        if(g > 0)
+            runBlocks<R>(sf, g, tuning_.best().thrs, tuning_.best().ghost);
+    }
 
-        for(auto&& holder : holders_)
-            copyBackToCircle(holder);
+    Tuning cachedTuning(std::size_t thrs, std::size_t r) const{
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex());
+            auto it = cache().find({ size_, thrs, r });
+            if(it != cache().end())
+                return it->second;
+        }
+        //thread counts 1, 2, 4, ... thrs, ghost widths 1, 4, 16, ... up to the largest one the partition allows
+        Tuning t;
+        t.size = size_;
+        t.maxThreads = thrs;
+        t.radius = r;
+        for(std::size_t threads = 1; ; threads = std::min(2 * threads, thrs)){
+            std::size_t maxGhost = std::max<std::size_t>((size_/threads - 1) / (2 * r), 1);
+            for(std::size_t ghost = 1; ghost < maxGhost; ghost *= 4)
+                t.candidates.push_back({ threads, ghost, -1 });
+            t.candidates.push_back({ threads, maxGhost, -1 });
+            if(threads == thrs)
+                break;
+        }
+        return t;
+    }
 
-        threads_.clear();
-        holders_.clear();
-        blocks_.clear();
+    //choices of the autotuner of every circle<ET>, by size, thread limit and stencil radius
+    static std::map<std::tuple<std::size_t, std::size_t, std::size_t>, Tuning>& cache(){
+        static std::map<std::tuple<std::size_t, std::size_t, std::size_t>, Tuning> tunings;
+        return tunings;
     }
 
+    static std::mutex& cacheMutex(){
+        static std::mutex mutex;
+        return mutex;
+    }
 
 private:
     std::size_t modulo(int a, int b) const{ return a >= 0 ? a % b : ( b - abs ( a%b ) ) % b; }
 
+    static std::uint64_t select(std::uint64_t s, std::uint64_t a, std::uint64_t b){ return (s & a) | (~s & b); }
+
+    void runPacked(unsigned rule, std::size_t g){
+        //cells packed into words, bit size_ (in one spare word) mirrors cell 0 so the circle wraps around
+        std::size_t words = size_/64 + 1;
+        std::vector<std::uint64_t> cur(words, 0), next(words, 0);
+        for(std::size_t i=0; i<size_; i++)
+            if(circle_[i])
+                cur[i/64] |= std::uint64_t(1) << (i%64);
+
+        //bit k of the rule as an all-ones or all-zeros mask, the rule is a tree of selects on left, centre, right
+        std::uint64_t b[8];
+        for(std::size_t k=0; k<8; k++)
+            b[k] = -std::uint64_t((rule >> k) & 1);
+
+        std::size_t last = size_ - 1;
+        for(std::size_t gen=0; gen<g; gen++){
+            std::uint64_t wrapBit = std::uint64_t(1) << (size_%64);
+            cur[size_/64] = (cur[size_/64] & ~wrapBit) | ((cur[0] & 1) ? wrapBit : 0);
+            std::uint64_t carry = (cur[last/64] >> (last%64)) & 1;
+            for(std::size_t w=0; w<words; w++){
+                std::uint64_t x = cur[w];
+                std::uint64_t l = (x << 1) | carry;
+                std::uint64_t r = (x >> 1) | (w+1 < words ? cur[w+1] << 63 : 0);
+                carry = x >> 63;
+                next[w] = select(l, select(x, select(r, b[7], b[6]), select(r, b[5], b[4])),
+                                    select(x, select(r, b[3], b[2]), select(r, b[1], b[0])));
+            }
+            cur.swap(next);
+        }
+
+        for(std::size_t i=0; i<size_; i++)
+            circle_[i] = (cur[i/64] >> (i%64)) & 1;
+    }
+
     void copyBackToCircle(holder<ET>& holder){
         if(holder.usingFirstBuffer_){
             for(std::size_t i=0; i<holder.w_;i++)
@@ -165,8 +542,14 @@ private:
     std::size_t size_;
     std::vector<ET> circle_;
     std::vector<holder<ET>> holders_;
-    std::vector<std::thread> threads_;
-    std::vector<std::size_t> blocks_;
+    std::unique_ptr<ThreadPool> pool_;
+    std::unique_ptr<Barrier> barrier_;
+    std::size_t spin_ = 4096;
+    bool neighbourSync_ = true;
+    std::size_t tileBytes_ = 32 * 1024; //fits L1
+    bool shrink_ = true;
+    bool autotune_ = false;
+    Tuning tuning_;
 
     friend class holder<ET>;
 };
@@ -174,12 +557,13 @@ private:
 template<typename ET>
 class holder{
 public:
-    holder(circle<ET>* circlePtr, Barrier* share_barrier, std::size_t id, std::size_t w, std::size_t g, std::size_t circleIndex){
+    holder(circle<ET>* circlePtr, Barrier* share_barrier, std::size_t id, std::size_t w, std::size_t g, std::size_t r, std::size_t circleIndex){
         circlePtr_ = circlePtr;
         share_barrier_ = share_barrier;
         id_ = id;
         w_ = w;
         g_ = g;
+        r_ = r;
         circleIndex_ = circleIndex;
         leftNeighbour_ = nullptr;
         rightNeighbour_ = nullptr;
@@ -189,60 +573,146 @@ public:
         copyBufferFromCircle();
     }
 
-    template<typename SF>
-    void operator()(SF sf, std::size_t g){
+    //prepares the holder for another run, the buffers only grow
+    void load(std::size_t w, std::size_t g, std::size_t r, std::size_t circleIndex){
+        w_ = w;
+        g_ = g;
+        r_ = r;
+        circleIndex_ = circleIndex;
+        buffers_.first.resize(g_+w_+g_);
+        buffers_.second.resize(g_+w_+g_);
+        copyBufferFromCircle();
+    }
+
+    template<std::size_t R, typename SF>
+    void run(SF sf, std::size_t g){
         //set neighbour pointers
         std::size_t holdersTotal = circlePtr_->holders_.size();
         leftNeighbour_ = &(circlePtr_->holders_[modulo(id_-1, holdersTotal)]);
         rightNeighbour_ = &(circlePtr_->holders_[modulo(id_+1, holdersTotal)]);
 
-        std::size_t n = g/g_;
-        std::size_t remainder = g % g_;
-
-        //std::vector<std::size_t>* blocks = &(circlePtr_->blocks_);
-        /*
-        for(std::size_t i=0; i<(*blocks).size(); i++){
-            for(std::size_t j=0; j<(*blocks)[i]; j++){
-                this->calculate(sf);
-            }
-            share_barrier_->Wait();
-            this->synchronize();
-            share_barrier_->Wait();
+        //blocks of g_/r_ generations (the last one may be shorter), ghost cells are exchanged between blocks
+        std::size_t perBlock = g_ / r_;
+        std::size_t blocks = (g + perBlock - 1) / perBlock;
+        for(std::size_t block=0; block < blocks; ++block){
+            if(block)
+                exchange();
+            std::size_t gens = std::min(perBlock, g - block*perBlock);
+            calculateBlock<R>(sf, gens);
         }
-        */
-       for(std::size_t block=0; block < n; ++block){
-           for(std::size_t gen = 0; gen<g_;++gen){
-               calculate(sf);
-           }
-           share_barrier_->Wait();
-           synchronize();
-           share_barrier_->Wait();
-       }
-
-       for(std::size_t gen = 0; gen<remainder; ++gen){
-           calculate(sf);
-       }
-       share_barrier_->Wait();
-       synchronize();
     }
 
 private:
     std::size_t modulo(int a, int b) const{ return a >= 0 ? a % b : ( b - abs ( a%b ) ) % b; }
 
-    template<typename SF>
-    void calculate(SF&& sf){       
-        
-        if(usingFirstBuffer_){
-            for(std::size_t i=0; i<=buffers_.first.size()-3; i++)
-                buffers_.second[i+1] = sf(buffers_.first[i], buffers_.first[i+1], buffers_.first[i+2]);
-            usingFirstBuffer_=false;
+    template<std::size_t R, typename SF>
+    void calculate(SF&& sf, std::size_t k){
+        //k-th generation of a block, cells [k*R, size-k*R) are the ones still valid
+        std::size_t m = margin(k);
+        step<R>(sf, usingFirstBuffer_, m, buffers_.first.size() - m);
+        usingFirstBuffer_ = !usingFirstBuffer_;
+    }
+
+    std::size_t margin(std::size_t k) const{
+        //ghost cells invalid in the k-th generation of a block, the whole buffer is computed without shrinking
+        return circlePtr_->shrink_ ? k * r_ : r_;
+    }
+
+    template<std::size_t R, typename SF>
+    void calculateBlock(SF&& sf, std::size_t gens){
+        //gens generations in parallelogram tiles: tile j covers cells [j*tile-k*R, (j+1)*tile-k*R) of generation k,
+        //so a tile runs all generations while its cells stay in L1; what it reads left of itself was computed
+        //by the previous tile and gets overwritten (two generations later) only further left
+        std::size_t size = buffers_.first.size();
+        std::size_t tile = std::max<std::size_t>(64, circlePtr_->tileBytes_ / (2 * sizeof(ET)));
+        if(gens < 2 || !circlePtr_->tileBytes_ || size <= 2 * tile){
+            for(std::size_t k=1; k<=gens; k++)
+                calculate<R>(sf, k);
+            return;
+        }
+        bool first = usingFirstBuffer_;
+        for(std::size_t left = 0; left < size - 1 + gens * R; left += tile){
+            for(std::size_t k=1; k<=gens; k++){
+                std::size_t lo = std::max(margin(k), left > k * R ? left - k * R : 0);
+                std::size_t hi = std::min(size - margin(k), left + tile > k * R ? left + tile - k * R : 0);
+                if(lo < hi)
+                    step<R>(sf, (k % 2 == 1) == first, lo, hi);
+            }
+        }
+        usingFirstBuffer_ = gens % 2 ? !first : first;
+    }
+
+    template<std::size_t R, typename SF>
+    void step(SF&& sf, bool fromFirst, std::size_t lo, std::size_t hi){
+        //computes cells [lo, hi) of the next generation from the other buffer
+        auto& src = fromFirst ? buffers_.first : buffers_.second;
+        auto& dst = fromFirst ? buffers_.second : buffers_.first;
+        if constexpr (R > 1){
+            std::array<ET, 2 * R + 1> cells;
+            for(std::size_t i=lo; i<hi; i++){
+                for(std::size_t j=0; j<cells.size(); j++)
+                    cells[j] = src[i - R + j];
+                dst[i] = sf(cells);
+            }
+        } else if constexpr (std::is_same<ET, bool>::value){
+            //vector<bool> buffers have no contiguous storage
+            for(std::size_t i=lo; i<hi; i++)
+                dst[i] = sf(src[i-1], src[i], src[i+1]);
+        } else if constexpr (has_row_kernel<std::decay_t<SF>, ET>::value){
+            sf.apply(src.data() + lo - 1, dst.data() + lo, hi - lo);
         } else {
-            for(std::size_t i=0; i<=buffers_.second.size()-3; i++)
-                buffers_.first[i+1] = sf(buffers_.second[i], buffers_.second[i+1], buffers_.second[i+2]);
-            usingFirstBuffer_=true;
+            const ET* in = src.data();
+            ET* out = dst.data();
+            for(std::size_t i=lo; i<hi; i++)
+                out[i] = sf(in[i-1], in[i], in[i+1]);
         }
+    }
+
+    struct HaloFlags;
 
+    static constexpr std::size_t maxYields = 16;
 
+    void exchange(){
+        if(!circlePtr_->neighbourSync_){
+            share_barrier_->Wait();
+            synchronize();
+            share_barrier_->Wait();
+            return;
+        }
+        //only the two neighbours are waited for: they publish their block, we copy the halos
+        //and they must copy ours before anybody overwrites them with the next block
+        ++step_;
+        publish(flags_->ready);
+        waitFor(*leftNeighbour_->flags_, leftNeighbour_->flags_->ready, step_);
+        waitFor(*rightNeighbour_->flags_, rightNeighbour_->flags_->ready, step_);
+        synchronize();
+        publish(flags_->consumed);
+        waitFor(*leftNeighbour_->flags_, leftNeighbour_->flags_->consumed, step_);
+        waitFor(*rightNeighbour_->flags_, rightNeighbour_->flags_->consumed, step_);
+    }
+
+    void publish(std::atomic<std::size_t>& flag){
+        //sequentially consistent with the sleepers count, so a neighbour either sees the step or is woken up
+        flag.store(step_);
+        if(flags_->sleepers.load() != 0){
+            { std::lock_guard<std::mutex> lock(flags_->mutex); }
+            flags_->changed.notify_all();
+        }
+    }
+
+    void waitFor(HaloFlags& flags, const std::atomic<std::size_t>& flag, std::size_t step) const{
+        //spins like the barrier does, gives the core away a few times, then sleeps until the neighbour publishes the step
+        std::size_t spin = share_barrier_->Spin();
+        for(std::size_t i = 0; i < spin + maxYields; i++){
+            if(flag.load(std::memory_order_acquire) >= step)
+                return;
+            if(i >= spin)
+                std::this_thread::yield();
+        }
+        std::unique_lock<std::mutex> lock(flags.mutex);
+        flags.sleepers.fetch_add(1);
+        flags.changed.wait(lock, [&flag, step] { return flag.load() >= step; });
+        flags.sleepers.fetch_sub(1);
     }
 
     void synchronize(){
@@ -288,12 +758,23 @@ private:
     std::pair<std::vector<ET>, std::vector<ET>> buffers_;
     std::size_t w_; //defines size of non overlapping/valid cells
     std::size_t g_; //defines size of overlapping/nonvalid cells
+    std::size_t r_ = 1; //stencil radius, a block has g_/r_ generations
     std::size_t id_; //id of thread this instance is initiated in
     std::size_t circleIndex_; //index where circle non overlapping part starts in circle
     holder<ET>* leftNeighbour_;
     holder<ET>* rightNeighbour_;
     bool usingFirstBuffer_ = false;
 
+    struct HaloFlags {
+        alignas(64) std::atomic<std::size_t> ready{0}; //last block whose cells are published
+        alignas(64) std::atomic<std::size_t> consumed{0}; //last block whose halos were copied from the neighbours
+        alignas(64) std::atomic<std::size_t> sleepers{0}; //neighbours blocked on the flags after spinning
+        std::mutex mutex;
+        std::condition_variable changed;
+    };
+    std::unique_ptr<HaloFlags> flags_ = std::make_unique<HaloFlags>();
+    std::size_t step_ = 0; //blocks exchanged so far, the same in all holders of a circle
+
     friend class circle<ET>;
     friend class holder<ET>;
 
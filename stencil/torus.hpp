@@ -0,0 +1,351 @@
+/*
+torus.hpp
+N-dimensional periodic grid, the ghost zone scheme of stencil1d.hpp on tiles
+*/
+
+#pragma once
+
+#include "stencil1d.hpp"
+
+template<typename ET, std::size_t N>
+class torus;
+template<typename ET, std::size_t N>
+class tile;
+
+//cells passed to a stencil besides the centre: von_neumann the 2N cells sharing a face,
+//moore all 3^N-1 cells sharing at least a corner, both in row-major order of their offsets
+enum class neighbourhood { von_neumann, moore };
+
+constexpr std::size_t neighbour_count(neighbourhood shape, std::size_t n){
+    std::size_t cube = 1;
+    for(std::size_t d=0; d<n; d++)
+        cube *= 3;
+    return shape == neighbourhood::von_neumann ? 2 * n : cube - 1;
+}
+
+//the grid is split into one tile per thread along all dimensions, each tile computes blocks of g
+//generations on its cells and a halo g cells deep, between blocks only the halos are copied
+template<typename ET, std::size_t N>
+class torus{
+    static_assert(N > 0, "a torus has at least one dimension");
+
+public:
+    using index = std::array<std::ptrdiff_t, N>;
+
+    torus(const std::array<std::size_t, N>& extents) {
+        extents_ = extents;
+        size_ = 1;
+        for(std::size_t d=N; d-- > 0;){
+            strides_[d] = size_;
+            size_ *= extents_[d];
+        }
+        grids_[0] = std::vector<cell_type>(size_);
+    }
+
+    //only cells are copied, tiles and threads belong to a single torus
+    torus(const torus& other) : torus(other.extents_) { grids_[0] = other.grids_[other.current_]; }
+
+    torus& operator=(const torus& other){
+        if(this != &other){
+            extents_ = other.extents_;
+            strides_ = other.strides_;
+            size_ = other.size_;
+            grids_[0] = other.grids_[other.current_];
+            grids_[1].clear();
+            current_ = 0;
+            tiles_.clear();
+        }
+        return *this;
+    }
+
+    std::size_t size() const { return size_; }
+
+    const std::array<std::size_t, N>& extents() const { return extents_; }
+
+    //spins of a waiting thread in the barrier before it sleeps, 0 selects the mutex barrier
+    void set_barrier_spin(std::size_t spin) { spin_ = spin; }
+
+    //generations of a block (the halo depth), 0 picks 1/64 of the narrowest tile: in N dimensions the
+    //redundant halo work grows with g in every direction, so blocks are much shorter than in a circle
+    void set_ghost(std::size_t g) { ghost_ = g; }
+
+    void set(const index& x, const ET& v){ grids_[current_][offset(x)] = v; }
+
+    ET get(const index& x) const{ return grids_[current_][offset(x)]; }
+
+    //g generations of sf(centre, neighbours), neighbours is a std::array<ET, neighbour_count(Shape, N)>
+    template<neighbourhood Shape = neighbourhood::moore, typename SF>
+    void run(SF&& sf, std::size_t g, std::size_t thrs = std::thread::hardware_concurrency()){
+        if(!g)
+            return;
+        std::array<std::size_t, N> counts = split(std::max<std::size_t>(thrs, 1));
+        std::size_t tilesTotal = 1;
+        std::size_t narrowest = size_;
+        for(std::size_t d=0; d<N; d++){
+            tilesTotal *= counts[d];
+            narrowest = std::min(narrowest, extents_[d] / counts[d]);
+        }
+        std::size_t myG = std::min(ghost_ ? ghost_ : std::max<std::size_t>(narrowest / 64, 1), g);
+
+        //threads, barrier and tiles (with their buffers) are reused while the tile count stays the same
+        if(!pool_ || pool_->Size() != tilesTotal){
+            tiles_.clear();
+            pool_.reset();
+            pool_ = std::make_unique<ThreadPool>(tilesTotal);
+            barrier_ = std::make_unique<Barrier>(tilesTotal);
+        }
+        barrier_->SetSpin(tilesTotal <= std::thread::hardware_concurrency() ? spin_ : 0);
+        grids_[1 - current_].resize(size_);
+
+        for(std::size_t i=0; i<tilesTotal; i++){
+            //tile i has coordinates i in the mixed radix of counts, the first tiles of a dimension get the remainder
+            std::array<std::size_t, N> origin, w;
+            std::size_t rest = i;
+            for(std::size_t d=N; d-- > 0;){
+                std::size_t t = rest % counts[d];
+                rest /= counts[d];
+                std::size_t base = extents_[d] / counts[d], rem = extents_[d] % counts[d];
+                origin[d] = t * base + std::min(t, rem);
+                w[d] = t < rem ? base + 1 : base;
+            }
+            if(tiles_.size() <= i)
+                tiles_.emplace_back(this, barrier_.get());
+            tiles_[i].load(origin, w, myG);
+        }
+
+        std::function<void(std::size_t)> job = [this, &sf, g](std::size_t i){ tiles_[i].template run<Shape>(sf, g); };
+        pool_->Run(job);
+        current_ = (current_ + (g + myG - 1) / myG) % 2;
+    }
+
+private:
+    //bool cells are kept in bytes, tiles write their cells to the shared grid concurrently
+    using cell_type = std::conditional_t<std::is_same<ET, bool>::value, unsigned char, ET>;
+
+    std::array<std::size_t, N> split(std::size_t thrs) const{
+        //prime factors of the thread count (largest first) go to the dimension with the widest tiles
+        std::vector<std::size_t> factors;
+        for(std::size_t f=2; f*f <= thrs; f++)
+            for(; thrs % f == 0; thrs /= f)
+                factors.push_back(f);
+        if(thrs > 1)
+            factors.push_back(thrs);
+        std::array<std::size_t, N> counts;
+        counts.fill(1);
+        for(std::size_t i=factors.size(); i-- > 0;){
+            std::size_t best = N;
+            for(std::size_t d=0; d<N; d++)
+                if(counts[d] * factors[i] <= extents_[d] && (best == N || extents_[d] / counts[d] > extents_[best] / counts[best]))
+                    best = d;
+            if(best < N)
+                counts[best] *= factors[i];
+        }
+        return counts;
+    }
+
+    std::size_t offset(const index& x) const{
+        std::size_t o = 0;
+        for(std::size_t d=0; d<N; d++)
+            o += modulo(x[d], extents_[d]) * strides_[d];
+        return o;
+    }
+
+    static std::size_t modulo(std::ptrdiff_t a, std::size_t b){
+        std::ptrdiff_t m = a % (std::ptrdiff_t)b;
+        return m < 0 ? m + b : m;
+    }
+
+    std::array<std::size_t, N> extents_;
+    std::array<std::size_t, N> strides_;
+    std::size_t size_;
+    //cells of the last generation are in grids_[current_], blocks publish alternately into both
+    std::array<std::vector<cell_type>, 2> grids_;
+    std::size_t current_ = 0;
+    std::size_t spin_ = 4096;
+    std::size_t ghost_ = 0;
+    std::unique_ptr<ThreadPool> pool_;
+    std::unique_ptr<Barrier> barrier_;
+    std::vector<tile<ET, N>> tiles_;
+
+    friend class tile<ET, N>;
+};
+
+template<typename ET, std::size_t N>
+class tile{
+    using cell_type = typename torus<ET, N>::cell_type;
+
+public:
+    tile(torus<ET, N>* torusPtr, Barrier* share_barrier){
+        torusPtr_ = torusPtr;
+        share_barrier_ = share_barrier;
+    }
+
+    //prepares the tile for a run: cells [origin, origin+w) with a halo of g cells, the buffers only grow
+    void load(const std::array<std::size_t, N>& origin, const std::array<std::size_t, N>& w, std::size_t g){
+        origin_ = origin;
+        w_ = w;
+        g_ = g;
+        std::size_t size = 1;
+        for(std::size_t d=N; d-- > 0;){
+            ext_[d] = g_ + w_[d] + g_;
+            stride_[d] = size;
+            size *= ext_[d];
+        }
+        buffers_.first.resize(size);
+        buffers_.second.resize(size);
+        usingFirstBuffer_ = true;
+        copyFromGrid(torusPtr_->current_, false);
+    }
+
+    template<neighbourhood Shape, typename SF>
+    void run(SF& sf, std::size_t g){
+        constexpr std::size_t K = neighbour_count(Shape, N);
+        std::array<std::ptrdiff_t, K> offsets = neighbourOffsets<Shape>();
+
+        //block b reads its halo from grid start+b and publishes into grid start+b+1, the other grid
+        //is rewritten only after the barrier, when no tile reads it any more
+        std::size_t grid = torusPtr_->current_;
+        std::size_t blocks = (g + g_ - 1) / g_;
+        for(std::size_t block=0; block < blocks; ++block){
+            if(block)
+                copyFromGrid(grid, true);
+            std::size_t gens = std::min(g_, g - block*g_);
+            for(std::size_t k=1; k<=gens; k++)
+                step(sf, offsets, k);
+            grid = 1 - grid;
+            copyToGrid(grid);
+            share_barrier_->Wait();
+        }
+    }
+
+private:
+    template<neighbourhood Shape>
+    std::array<std::ptrdiff_t, neighbour_count(Shape, N)> neighbourOffsets() const{
+        std::array<std::ptrdiff_t, neighbour_count(Shape, N)> offsets;
+        std::size_t j = 0;
+        if constexpr (Shape == neighbourhood::von_neumann){
+            for(std::size_t d=0; d<N; d++){
+                offsets[j++] = -(std::ptrdiff_t)stride_[d];
+                offsets[j++] = stride_[d];
+            }
+        } else {
+            //digit d of code (dimension 0 most significant) is the offset + 1 in dimension d
+            for(std::size_t code=0; j < offsets.size(); code++){
+                std::ptrdiff_t o = 0;
+                bool centre = true;
+                std::size_t rest = code;
+                for(std::size_t d=N; d-- > 0;){
+                    std::ptrdiff_t digit = rest % 3;
+                    rest /= 3;
+                    o += (digit - 1) * (std::ptrdiff_t)stride_[d];
+                    centre = centre && digit == 1;
+                }
+                if(!centre)
+                    offsets[j++] = o;
+            }
+        }
+        return offsets;
+    }
+
+    template<typename SF, std::size_t K>
+    void step(SF& sf, const std::array<std::ptrdiff_t, K>& offsets, std::size_t k){
+        //k-th generation of a block, cells [k, ext-k) in every dimension are the ones still valid
+        const cell_type* in = usingFirstBuffer_ ? buffers_.first.data() : buffers_.second.data();
+        cell_type* out = usingFirstBuffer_ ? buffers_.second.data() : buffers_.first.data();
+        std::size_t hi = ext_[N-1] - k;
+        forEachRow(k, [&](std::size_t row){
+            //one pointer per neighbour, shifted along the row together with the centre
+            std::array<const cell_type*, K> from;
+            for(std::size_t j=0; j<K; j++)
+                from[j] = in + row + offsets[j];
+            for(std::size_t x=k; x<hi; x++){
+                std::array<ET, K> neighbours;
+                for(std::size_t j=0; j<K; j++)
+                    neighbours[j] = from[j][x];
+                out[row + x] = sf(ET(in[row + x]), neighbours);
+            }
+        });
+        usingFirstBuffer_ = !usingFirstBuffer_;
+    }
+
+    template<typename F>
+    void forEachRow(std::size_t margin, F&& f) const{
+        //calls f(offset of the row start) for rows with all outer coordinates in [margin, ext-margin)
+        std::array<std::size_t, N> i;
+        i.fill(margin);
+        for(;;){
+            std::size_t row = 0;
+            for(std::size_t d=0; d+1<N; d++)
+                row += i[d] * stride_[d];
+            f(row);
+            std::size_t d = N - 1;
+            for(;;){
+                if(d == 0)
+                    return;
+                --d;
+                if(++i[d] < ext_[d] - margin)
+                    break;
+                i[d] = margin;
+            }
+        }
+    }
+
+    bool innerRow(std::size_t row) const{
+        //true when all outer coordinates of the row lie in the tile's own cells
+        for(std::size_t d=0; d+1<N; d++){
+            std::size_t c = row / stride_[d] % ext_[d];
+            if(c < g_ || c >= g_ + w_[d])
+                return false;
+        }
+        return true;
+    }
+
+    std::size_t gridRow(std::size_t row) const{
+        //offset in the torus of the row start (halo coordinates wrap around)
+        std::size_t o = 0;
+        for(std::size_t d=0; d+1<N; d++){
+            std::size_t c = row / stride_[d] % ext_[d];
+            o += torus<ET, N>::modulo((std::ptrdiff_t)(origin_[d] + c) - (std::ptrdiff_t)g_, torusPtr_->extents_[d]) * torusPtr_->strides_[d];
+        }
+        return o;
+    }
+
+    void copyFromGrid(std::size_t grid, bool haloOnly){
+        //the whole buffer or only the halo, from the cells of the torus the buffer overlaps
+        const cell_type* src = torusPtr_->grids_[grid].data();
+        cell_type* dst = usingFirstBuffer_ ? buffers_.first.data() : buffers_.second.data();
+        std::size_t inner = w_[N-1], extent = torusPtr_->extents_[N-1];
+        std::size_t first = torus<ET, N>::modulo((std::ptrdiff_t)origin_[N-1] - (std::ptrdiff_t)g_, extent);
+        forEachRow(0, [&](std::size_t row){
+            const cell_type* from = src + gridRow(row);
+            bool skipInner = haloOnly && innerRow(row);
+            std::size_t x = first;
+            for(std::size_t p=0; p<ext_[N-1]; p++){
+                if(!skipInner || p < g_ || p >= g_ + inner)
+                    dst[row + p] = from[x];
+                if(++x == extent)
+                    x = 0;
+            }
+        });
+    }
+
+    void copyToGrid(std::size_t grid){
+        //own cells only, they never wrap around
+        cell_type* dst = torusPtr_->grids_[grid].data();
+        const cell_type* src = usingFirstBuffer_ ? buffers_.first.data() : buffers_.second.data();
+        forEachRow(0, [&](std::size_t row){
+            if(innerRow(row))
+                std::copy(src + row + g_, src + row + g_ + w_[N-1], dst + gridRow(row) + origin_[N-1]);
+        });
+    }
+
+    torus<ET, N>* torusPtr_;
+    Barrier* share_barrier_;
+    std::pair<std::vector<cell_type>, std::vector<cell_type>> buffers_;
+    std::array<std::size_t, N> origin_; //first own cell in the torus
+    std::array<std::size_t, N> w_; //own cells in every dimension
+    std::array<std::size_t, N> ext_; //own cells and both halos in every dimension
+    std::array<std::size_t, N> stride_; //row-major strides of the buffers
+    std::size_t g_; //halo depth, generations of a block
+    bool usingFirstBuffer_ = true;
+};